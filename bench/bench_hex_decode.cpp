@@ -0,0 +1,138 @@
+// Benchmark for the record decoder: the original std::stoul(substr) parser
+// against decode_hex_record(), on records held in memory so that only the
+// decoding is timed.
+//
+// Usage: bench_hex_decode [record count]   (default 1000000, 16 data bytes each)
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "HexParser.h"
+
+// The parser as it was before the nibble table: two allocations and an
+// exception-capable call per byte. Kept here only as the baseline.
+static std::optional<HexRecord> parse_hex_record_stoul(const std::string& line) {
+    if (line.empty() || line[0] != ':') {
+        return std::nullopt;
+    }
+    std::string hex_string = line.substr(1);
+    std::vector<uint8_t> bytes_list;
+    try {
+        for (size_t i = 0; i < hex_string.length(); i += 2) {
+            bytes_list.push_back(static_cast<uint8_t>(std::stoul(hex_string.substr(i, 2), nullptr, 16)));
+        }
+    } catch (...) {
+        return std::nullopt;
+    }
+    if (bytes_list.size() < 5) {
+        return std::nullopt;
+    }
+    if (static_cast<uint8_t>(std::accumulate(bytes_list.begin(), bytes_list.end(), 0)) != 0) {
+        return std::nullopt;
+    }
+    HexRecord record;
+    record.byte_count = bytes_list[0];
+    if (bytes_list.size() != (size_t)record.byte_count + 5) {
+        return std::nullopt;
+    }
+    record.address = (bytes_list[1] << 8) | bytes_list[2];
+    record.record_type = bytes_list[3];
+    record.checksum = bytes_list.back();
+    record.data.assign(bytes_list.begin() + 4, bytes_list.end() - 1);
+    return record;
+}
+
+// Sequential 16-byte data records with pseudo-random payloads.
+static std::vector<std::string> make_records(size_t count) {
+    static const char digits[] = "0123456789ABCDEF";
+    std::vector<std::string> lines;
+    lines.reserve(count);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t bytes[21] = {16, uint8_t(i >> 4 >> 8), uint8_t(i << 4), 0x00};
+        for (int b = 4; b < 20; ++b) {
+            seed = seed * 1103515245 + 12345;
+            bytes[b] = static_cast<uint8_t>(seed >> 16);
+        }
+        bytes[20] = static_cast<uint8_t>(-std::accumulate(bytes, bytes + 20, 0));
+        std::string line = ":";
+        for (uint8_t byte : bytes) {
+            line += digits[byte >> 4];
+            line += digits[byte & 0x0F];
+        }
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+// Best of three runs of 'body', in milliseconds. 'body' returns a checksum
+// of what it decoded, so the work cannot be optimised away.
+template <typename Body>
+static double time_best_of_3(Body body, uint64_t& checksum) {
+    double best = 1e300;
+    for (int run = 0; run < 3; ++run) {
+        auto started = std::chrono::steady_clock::now();
+        checksum = body();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::vector<std::string> lines = make_records(count);
+    size_t text_bytes = 0;
+    for (const std::string& line : lines) {
+        text_bytes += line.size();
+    }
+
+    uint64_t old_sum = 0, new_sum = 0, view_sum = 0;
+    double old_ms = time_best_of_3([&] {
+        uint64_t sum = 0;
+        for (const std::string& line : lines) {
+            if (std::optional<HexRecord> record = parse_hex_record_stoul(line)) {
+                sum += record->address + record->data.back();
+            }
+        }
+        return sum;
+    }, old_sum);
+    double new_ms = time_best_of_3([&] {
+        uint64_t sum = 0;
+        HexRecord record;
+        for (const std::string& line : lines) {
+            if (decode_hex_record(line.data(), line.data() + line.size(), record) == HexStatus::Ok) {
+                sum += record.address + record.data.back();
+            }
+        }
+        return sum;
+    }, new_sum);
+    double view_ms = time_best_of_3([&] {
+        uint64_t sum = 0;
+        HexRecordView record;
+        uint8_t payload[255];
+        for (const std::string& line : lines) {
+            if (decode_hex_record(line.data(), line.data() + line.size(), record, payload) == HexStatus::Ok) {
+                sum += record.address + record.data[record.data.size - 1];
+            }
+        }
+        return sum;
+    }, view_sum);
+
+    double mib = text_bytes / (1024.0 * 1024.0);
+    std::printf("%zu records, %.1f MiB of text\n", count, mib);
+    std::printf("  %-34s %9.1f ms  %8.1f MiB/s\n", "stoul(substr), the old path", old_ms, mib / old_ms * 1000);
+    std::printf("  %-34s %9.1f ms  %8.1f MiB/s  %5.1fx\n", "decode_hex_record -> HexRecord", new_ms,
+                mib / new_ms * 1000, old_ms / new_ms);
+    std::printf("  %-34s %9.1f ms  %8.1f MiB/s  %5.1fx\n", "decode_hex_record -> view", view_ms,
+                mib / view_ms * 1000, old_ms / view_ms);
+    if (old_sum != new_sum || old_sum != view_sum) {
+        std::printf("ERROR: the decoders disagree\n");
+        return 1;
+    }
+    return 0;
+}
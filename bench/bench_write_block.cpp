@@ -0,0 +1,142 @@
+// Benchmark for building the memory image from parsed records: the original
+// std::map<uint32_t, uint8_t> build, per-byte MemoryImage::write, and
+// build_memory_map, which copies each record with write_block.
+//
+// Usage: bench_write_block [--all]
+// The std::map build of the 64 MB image takes tens of seconds and several
+// GB of memory, so it only runs with --all.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "HexParser.h"
+#include "Memory.h"
+
+// An image of 'size' bytes as sequential 16-byte data records, with a 0x04
+// record at every 64 KB boundary as a HEX file would have.
+static HexRecordSet make_records(size_t size) {
+    HexRecordSet records;
+    records.reserve(size / 16 + size / 0x10000 + 1, size + 2 * (size / 0x10000 + 1));
+    uint8_t payload[16];
+    uint32_t seed = 12345;
+    for (size_t address = 0; address < size; address += 16) {
+        if (address % 0x10000 == 0) {
+            uint8_t high[2] = {uint8_t(address >> 24), uint8_t(address >> 16)};
+            records.push_back({2, 0, 0x04, {high, 2}, 0});
+        }
+        for (uint8_t& byte : payload) {
+            seed = seed * 1103515245 + 12345;
+            byte = static_cast<uint8_t>(seed >> 16);
+        }
+        records.push_back({16, uint16_t(address), 0x00, {payload, 16}, 0});
+    }
+    return records;
+}
+
+// The build as it was before MemoryImage: one map node per byte.
+static std::map<uint32_t, uint8_t> build_map(const HexRecordSet& records) {
+    std::map<uint32_t, uint8_t> memory;
+    uint32_t high_address = 0;
+    for (HexRecordView record : records) {
+        if (record.record_type == 0x00) {
+            uint32_t current_address = high_address + record.address;
+            for (uint8_t byte : record.data) {
+                memory[current_address++] = byte;
+            }
+        } else if (record.record_type == 0x04) {
+            high_address = ((record.data[0] << 8) | record.data[1]) << 16;
+        }
+    }
+    return memory;
+}
+
+// The same walk writing one byte at a time into a MemoryImage.
+static MemoryImage build_per_byte(const HexRecordSet& records) {
+    MemoryImage memory;
+    uint32_t high_address = 0;
+    for (HexRecordView record : records) {
+        if (record.record_type == 0x00) {
+            uint32_t current_address = high_address + record.address;
+            for (uint8_t byte : record.data) {
+                memory.write(current_address++, byte);
+            }
+        } else if (record.record_type == 0x04) {
+            high_address = ((record.data[0] << 8) | record.data[1]) << 16;
+        }
+    }
+    memory.compact();
+    return memory;
+}
+
+// Best of 'runs' runs of 'body', in milliseconds; 'result' keeps the last build.
+template <typename Result, typename Body>
+static double time_best_of(int runs, Body body, Result& result) {
+    double best = 1e300;
+    for (int run = 0; run < runs; ++run) {
+        auto started = std::chrono::steady_clock::now();
+        result = body();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count());
+    }
+    return best;
+}
+
+// True if 'image' holds exactly the bytes of the records.
+static bool same_bytes(const MemoryImage& image, const HexRecordSet& records, size_t size) {
+    if (image.size() != size) {
+        return false;
+    }
+    uint32_t high_address = 0;
+    for (HexRecordView record : records) {
+        if (record.record_type == 0x04) {
+            high_address = ((record.data[0] << 8) | record.data[1]) << 16;
+            continue;
+        }
+        for (size_t i = 0; i < record.data.size; ++i) {
+            if (image.read(high_address + record.address + uint32_t(i)) != record.data[i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool all = argc > 1 && std::strcmp(argv[1], "--all") == 0;
+    const struct {
+        size_t size;
+        const char* name;
+    } sizes[] = {{64 * 1024, "64 KB"}, {1024 * 1024, "1 MB"}, {64 * 1024 * 1024, "64 MB"}};
+
+    bool agree = true;
+    std::printf("%-6s %14s %14s %14s %8s\n", "image", "std::map", "per-byte", "write_block", "speedup");
+    for (const auto& entry : sizes) {
+        HexRecordSet records = make_records(entry.size);
+        int runs = entry.size <= 1024 * 1024 ? 5 : 1;
+
+        double map_ms = 0;
+        if (all || entry.size <= 1024 * 1024) {
+            std::map<uint32_t, uint8_t> map;
+            map_ms = time_best_of(runs, [&] { return build_map(records); }, map);
+            agree = agree && map.size() == entry.size;
+        }
+        MemoryImage per_byte, bulk;
+        double per_byte_ms = time_best_of(runs, [&] { return build_per_byte(records); }, per_byte);
+        double bulk_ms = time_best_of(runs, [&] { return build_memory_map(records); }, bulk);
+        agree = agree && same_bytes(per_byte, records, entry.size) && same_bytes(bulk, records, entry.size);
+
+        if (map_ms > 0) {
+            std::printf("%-6s %11.1f ms %11.1f ms %11.1f ms %7.0fx\n", entry.name, map_ms, per_byte_ms, bulk_ms,
+                        map_ms / bulk_ms);
+        } else {
+            std::printf("%-6s %14s %11.1f ms %11.1f ms %8s\n", entry.name, "(--all)", per_byte_ms, bulk_ms, "");
+        }
+    }
+    if (!agree) {
+        std::printf("ERROR: the builds disagree\n");
+        return 1;
+    }
+    return 0;
+}
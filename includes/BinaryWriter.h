@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+#include "MemoryImage.h"
+
+// What part of the image to export as a flat binary, and how to lay it out.
+struct BinaryExportOptions {
+    uint8_t fill = 0xFF;                 // Written wherever the image has no byte
+    std::optional<uint32_t> start;       // First address; default is the lowest present one
+    std::optional<uint32_t> end;         // Last address (inclusive); default is the highest present one
+    uint64_t split_size = 0;             // Bytes per PROM image, 0 = no splitting. The last part is padded.
+    unsigned interleave = 1;             // Byte lanes: 1 = none, 2 = even/odd (16-bit bus), 4 = 32-bit bus
+};
+
+// Receives the output in order: for each step, the same number of bytes for
+// every lane, addressed by (lane, part). Return false to stop.
+using BinaryLaneSink = std::function<bool(unsigned lane, uint64_t part, const uint8_t* data, size_t size)>;
+
+// Streams the selected range as a flat image with gaps filled, dealt into
+// byte lanes and cut into parts. Present bytes go straight from the image's
+// segments and gaps come from a small fill block, so a sparse 32-bit image
+// never needs a full-size buffer. Returns false for an empty or inverted
+// range, an unsupported interleave, or when the sink fails.
+bool export_binary(const MemoryImage& memory, const BinaryExportOptions& options, const BinaryLaneSink& sink);
+
+// Writes the export to files named after 'file_path': "rom.bin" as is, or
+// "rom_even.bin"/"rom_odd.bin" (lanes "_b0".."_b3" for 4-way interleave)
+// and "_0", "_1", ... per part when splitting. The names written are added
+// to 'written' if given.
+bool export_binary_file(const std::string& file_path, const MemoryImage& memory, const BinaryExportOptions& options,
+                        std::vector<std::string>* written = nullptr);
+
+// The file name export_binary_file uses for one lane and part.
+std::string binary_export_path(const std::string& file_path, const BinaryExportOptions& options, unsigned lane, uint64_t part);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// A read-only view of contiguous bytes owned by someone else (C++17 has no std::span).
+struct ByteSpan {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    const uint8_t* begin() const { return data; }
+    const uint8_t* end() const { return data + size; }
+    bool empty() const { return size == 0; }
+    uint8_t operator[](size_t i) const { return data[i]; }
+};
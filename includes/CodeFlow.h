@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "MemoryImage.h"
+#include "Disassembly.h"
+
+// Which bytes of an image are code, found by following the program from its
+// entry points instead of sweeping every byte. Kept as two bitmaps per
+// segment: the first byte of each instruction, and every byte an
+// instruction covers. Everything else is data. A segment's bitmaps are only
+// allocated once the analysis reaches it.
+class CodeMap {
+    public:
+        bool is_code(uint32_t address) const { return test(address, &Bits::code); }
+        bool is_instruction_start(uint32_t address) const { return test(address, &Bits::starts); }
+
+        size_t instruction_count() const { return instruction_count_; }
+        size_t code_bytes() const { return code_bytes_; }
+
+        // Every JMP/Jcc/CALL/Ccc operand met in code, sorted and unique.
+        // These are the addresses that get labels.
+        const std::vector<uint32_t>& targets() const { return targets_; }
+
+    private:
+        friend CodeMap analyze_code_flow(const MemoryImage& memory, CpuType cpu,
+                                         const std::vector<uint32_t>& entry_points);
+        friend std::vector<DisassembledInstruction> disassemble_code_map(const MemoryImage& memory,
+                                                                         CpuDisassembler& disassembler,
+                                                                         const CodeMap& code);
+
+        struct Bits {
+            uint32_t start;               // First address of the segment
+            size_t length;
+            std::vector<uint64_t> starts; // Empty until the segment holds code
+            std::vector<uint64_t> code;
+        };
+
+        static bool get(const std::vector<uint64_t>& bits, size_t offset) {
+            return !bits.empty() && (bits[offset >> 6] >> (offset & 63)) & 1;
+        }
+        static void set(std::vector<uint64_t>& bits, size_t offset) { bits[offset >> 6] |= uint64_t(1) << (offset & 63); }
+
+        // The segment holding 'address', or nullptr. O(log segments).
+        const Bits* find(uint32_t address) const;
+        bool test(uint32_t address, std::vector<uint64_t> Bits::*which) const {
+            const Bits* bits = find(address);
+            return bits && get(bits->*which, address - bits->start);
+        }
+
+        std::vector<Bits> segments_;
+        std::vector<uint32_t> targets_;
+        size_t instruction_count_ = 0;
+        size_t code_bytes_ = 0;
+};
+
+// What decides which bytes are listed as code.
+enum class DisassemblyMode { LinearSweep, FollowFlow };
+
+// Settings for the follow-flow mode.
+struct CodeFlowOptions {
+    DisassemblyMode mode = DisassemblyMode::LinearSweep;
+    bool interrupt_vectors = true;      // Start at the RST vectors (and the 8085 TRAP/RSTx.5 ones)
+    std::vector<uint32_t> entry_points; // Extra addresses given by the user
+};
+
+// The addresses the analysis starts from: the reset vector 0x0000, the
+// interrupt vectors if enabled, the file's start address and the user's
+// addresses, keeping only those present in the image. If none is present
+// the lowest address of the image is used, since a ROM dump placed
+// elsewhere usually starts with code.
+std::vector<uint32_t> collect_entry_points(const MemoryImage& memory, CpuType cpu, const CodeFlowOptions& options,
+                                           std::optional<uint32_t> start_address);
+
+// Follows JMP/CALL/Jcc/Ccc/RST/RET from the entry points with a worklist,
+// marking every instruction it reaches. Calls and RSTs are assumed to
+// return. A path stops at RET, JMP, PCHL and HLT, at an undefined opcode,
+// at an instruction with bytes missing from the image, and where it would
+// decode across an instruction found earlier. The cost is proportional to
+// the reachable code, not to the size of the image.
+CodeMap analyze_code_flow(const MemoryImage& memory, CpuType cpu, const std::vector<uint32_t>& entry_points);
+
+// Lists the image with the code map deciding what is code. Instructions
+// are decoded where the map marks them; every other byte becomes a DB line
+// of up to 4 bytes, with runs of 4 or more 0x00/0xFF folded as in the
+// linear sweep. Data lines never cross a label, so every label has a line.
+std::vector<DisassembledInstruction> disassemble_code_map(const MemoryImage& memory, CpuDisassembler& disassembler,
+                                                          const CodeMap& code);
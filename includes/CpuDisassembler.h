@@ -1,16 +1,31 @@
 #pragma once
 
-#include <string>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
-#include "Memory.h"  // Needed for MemoryMap
+#include "ByteSpan.h"
+#include "Memory.h"  // Needed for MemoryImage
 #include "Symbols.h" // Needed for SymbolMap
 
+// Bits of DisassembledInstruction::flags.
+enum InstructionFlag : uint8_t {
+    kInstructionDataRun = 1 << 0, // A "DB" line standing for a run of repeated bytes
+    kInstructionMissing = 1 << 1, // No byte at the address; shown as "???"
+    kInstructionData    = 1 << 2  // A "DB" line of 'size' (1-4) data bytes, packed in 'opcode' and 'operand'
+};
+
+// One decoded instruction in binary form. Images produce hundreds of
+// thousands of these, so there is no text here: format_instruction (see
+// Disassembly.h) writes it only when a row is shown or exported.
 struct DisassembledInstruction {
     uint32_t address;
-    std::string instruction_text;
-    uint8_t size;  // The number of bytes the instruction occupies (1,2, or 3)
+    uint32_t operand;  // The 8/16-bit operand, the byte count of a data run, or data bytes 2-4
+    uint8_t opcode;    // The opcode, the repeated byte of a data run, or the first data byte
+    uint8_t size;      // The number of bytes the instruction occupies (1,2, or 3; 1-4 for data)
+    uint8_t flags;     // InstructionFlag bits
+    uint8_t reserved;
 };
+static_assert(sizeof(DisassembledInstruction) == 12, "DisassembledInstruction should stay 12 bytes");
 
 // Creating an abstract class the defines what the disassembler must be capable of doing.
 class CpuDisassembler {
@@ -19,5 +34,18 @@ class CpuDisassembler {
 
         // A pure virtual function that any class cn inherit from.
         // The must provide an implementation for this function.
-        virtual DisassembledInstruction disassemble_op(const MemoryMap& memory, uint32_t pc, const SymbolMap& symbols) = 0;
-};
\ No newline at end of file
+        virtual DisassembledInstruction disassemble_op(const MemoryImage& memory, uint32_t pc) = 0;
+
+        // Decodes, back to back, every instruction that starts in the first
+        // 'limit' bytes of 'bytes' and appends them to 'out'. 'bytes' holds
+        // the code at 'base_address'; operand bytes past its end read as 0.
+        // Returns the offset just past the last instruction decoded. One
+        // virtual call covers a whole run of code.
+        virtual size_t disassemble_range(ByteSpan bytes, uint32_t base_address,
+                                         std::vector<DisassembledInstruction>& out, size_t limit) = 0;
+
+        // Decodes all of 'bytes'.
+        size_t disassemble_range(ByteSpan bytes, uint32_t base_address, std::vector<DisassembledInstruction>& out) {
+            return disassemble_range(bytes, base_address, out, bytes.size);
+        }
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <memory>
+#include <vector>
+#include "CpuDisassembler.h"
+#include "OpcodeTable.h"
+#include "Progress.h"
+
+// The CPUs the tool can disassemble for.
+enum class CpuType { I8080, I8085 };
+
+// Creates the disassembler for the selected CPU.
+std::unique_ptr<CpuDisassembler> make_disassembler(CpuType cpu);
+
+// The opcode table the selected CPU decodes with.
+const OpcodeTable& opcode_table(CpuType cpu);
+
+// Disassembles every present byte of the image from its lowest to its highest
+// address. Runs of 4 or more 0x00/0xFF bytes are folded into one DB line, and
+// gaps between segments are skipped.
+std::vector<DisassembledInstruction> disassemble_image(const MemoryImage& memory, CpuDisassembler& disassembler,
+                                                       const ProgressCallback& progress = nullptr);
+
+// Same output as disassemble_image, decoded on the shared thread pool. The
+// image is cut into windows of whole segments or slices of big ones, and
+// each window is decoded as if the sweep entered it at its first byte.
+// Where the real sweep enters a window later (an operand or DB run crossing
+// the edge), it is re-decoded from there until it meets the speculative
+// decode. 'disassembler' is shared by all threads, so it must not keep
+// state; the built-in ones do not. Progress is reported per window, from
+// pool threads but never concurrently. Small images are disassembled
+// serially. thread_count == 0 uses every core.
+std::vector<DisassembledInstruction> disassemble_image_parallel(const MemoryImage& memory,
+                                                                CpuDisassembler& disassembler,
+                                                                const ProgressCallback& progress = nullptr,
+                                                                unsigned thread_count = 0);
+
+// Writes the listing text of one instruction ("MVI  A, #$3F", "JNZ  L0100",
+// "DB   0FFh (16 bytes)") into [first, last), like std::to_chars: returns one
+// past the last character written, with no terminating NUL. Text that does
+// not fit is cut off at 'last'. Branch targets use their label from 'symbols'.
+char* format_instruction(char* first, char* last, const DisassembledInstruction& instr,
+                         const OpcodeTable& opcodes, const SymbolMap& symbols);
+
+// Writes a listing in the "Save Disassembly" format: each instruction as
+// "  0xADDR:  text", preceded by a blank line and "label:" where a symbol is.
+void write_disassembly_listing(std::ostream& out, const std::vector<DisassembledInstruction>& disassembly,
+                               CpuType cpu, const SymbolMap& symbols);
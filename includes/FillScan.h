@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ByteSpan.h"
+
+// Scans for runs of a fill value (0x00 for blank ROM, 0xFF for erased flash)
+// in an already loaded or mapped buffer. The kernels compare 16 (SSE2) or
+// 32 (AVX2) bytes per step, picked once at runtime, with a scalar fallback.
+
+// Offset of the first byte that differs from 'fill', or bytes.size if there is none.
+size_t find_first_not_fill(ByteSpan bytes, uint8_t fill);
+
+// One past the offset of the last byte that differs from 'fill', or 0 if there is none.
+size_t find_last_not_fill_end(ByteSpan bytes, uint8_t fill);
+
+// A run of consecutive fill bytes inside a buffer.
+struct FillRun {
+    size_t offset;
+    size_t length;
+};
+
+// Every run of 'fill' that is at least 'min_length' bytes long, in order.
+std::vector<FillRun> find_fill_runs(ByteSpan bytes, uint8_t fill, size_t min_length = 1);
+
+// Name of the kernel in use ("AVX2", "SSE2" or "scalar").
+const char* fill_scan_kernel_name();
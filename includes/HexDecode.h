@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Maps every ASCII character to its nibble value. Anything that is not a hex
+// digit maps to 0xFF, so OR-ing the lookups of a whole record and testing the
+// high bits tells us in one go whether any character was invalid.
+constexpr std::array<uint8_t, 256> make_nibble_table() {
+    std::array<uint8_t, 256> table{};
+    for (int i = 0; i < 256; ++i) {
+        table[i] = 0xFF;
+    }
+    for (int i = 0; i < 10; ++i) {
+        table['0' + i] = static_cast<uint8_t>(i);
+    }
+    for (int i = 0; i < 6; ++i) {
+        table['A' + i] = static_cast<uint8_t>(10 + i);
+        table['a' + i] = static_cast<uint8_t>(10 + i);
+    }
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> nibble_table = make_nibble_table();
+
+// Decodes the two hex digits at 'p'. Invalid digits are flagged in the high bits of 'bad'.
+inline uint8_t decode_hex_pair(const char* p, uint8_t& bad) {
+    uint8_t hi = nibble_table[static_cast<unsigned char>(p[0])];
+    uint8_t lo = nibble_table[static_cast<unsigned char>(p[1])];
+    bad |= hi | lo;
+    return static_cast<uint8_t>((hi << 4) | (lo & 0x0F));
+}
+
+// Decodes 'count' bytes from the 2 * 'count' ASCII hex digits at 'src' into 'dst'
+// and adds every decoded byte to 'sum' (modulo 256, like the record checksum).
+// Returns false if any character was not a hex digit; 'dst' is then unspecified.
+//
+// Uses an AVX2 or SSE2 kernel when the CPU supports it (picked once at runtime)
+// and a table-driven scalar loop otherwise and for the tail.
+bool decode_hex_bytes(const char* src, size_t count, uint8_t* dst, uint8_t& sum);
+
+// The scalar reference implementation, always available.
+bool decode_hex_bytes_scalar(const char* src, size_t count, uint8_t* dst, uint8_t& sum);
+
+// Name of the kernel decode_hex_bytes dispatches to ("AVX2", "SSE2" or "scalar").
+const char* hex_decoder_name();
+
+// Upper-case ASCII hex for every byte value, two characters per entry.
+constexpr std::array<char, 512> make_hex_pair_table() {
+    const char digits[] = "0123456789ABCDEF";
+    std::array<char, 512> table{};
+    for (int i = 0; i < 256; ++i) {
+        table[i * 2] = digits[i >> 4];
+        table[i * 2 + 1] = digits[i & 0x0F];
+    }
+    return table;
+}
+
+inline constexpr std::array<char, 512> hex_pair_table = make_hex_pair_table();
+
+// Writes 'value' as two upper-case hex digits at 'p'.
+inline void encode_hex_pair(uint8_t value, char* p) {
+    p[0] = hex_pair_table[value * 2];
+    p[1] = hex_pair_table[value * 2 + 1];
+}
+
+// Encodes 'count' bytes from 'src' as 2 * 'count' upper-case hex digits at
+// 'dst' and adds every byte to 'sum' (modulo 256). The inverse of
+// decode_hex_bytes; uses an SSE2 kernel when available, the table otherwise.
+void encode_hex_bytes(const uint8_t* src, size_t count, char* dst, uint8_t& sum);
+
+// The scalar reference implementation, always available.
+void encode_hex_bytes_scalar(const uint8_t* src, size_t count, char* dst, uint8_t& sum);
@@ -4,7 +4,11 @@
 #include <vector>
 #include <cstdint>
 #include <optional>
-#include <map>
+#include <functional>
+#include "ByteSpan.h"
+#include "MemoryImage.h"
+#include "MappedFile.h"
+#include "Progress.h"
 
 // Represents a single parsed line from an Intel HEX file.
 struct HexRecord {
@@ -15,14 +19,201 @@ struct HexRecord {
     uint8_t checksum;
 };
 
+// A decoded record whose payload points into a buffer owned by the parser.
+// It is only valid for the duration of the visitor call that receives it.
+struct HexRecordView {
+    uint8_t byte_count;
+    uint16_t address;
+    uint8_t record_type;
+    ByteSpan data;
+    uint8_t checksum;
+};
+
+// Views an owned record, e.g. to feed stored records through view-based code.
+inline HexRecordView view_of(const HexRecord& record) {
+    return {record.byte_count, record.address, record.record_type,
+            {record.data.data(), record.data.size()}, record.checksum};
+}
+
+// A set of records stored without one allocation per record. Each record is
+// a small fixed-size header, and every payload lives in one contiguous arena
+// owned by the set. Records are handed out as HexRecordView spans into that
+// arena. The set is move-only, so records are never copied behind our back.
+class HexRecordSet {
+    public:
+        HexRecordSet() = default;
+        HexRecordSet(const HexRecordSet&) = delete;
+        HexRecordSet& operator=(const HexRecordSet&) = delete;
+        HexRecordSet(HexRecordSet&&) noexcept = default;
+        HexRecordSet& operator=(HexRecordSet&&) noexcept = default;
+
+        size_t size() const { return headers_.size(); }
+        bool empty() const { return headers_.empty(); }
+        size_t payload_bytes() const { return arena_.size(); }
+        void clear() { headers_.clear(); arena_.clear(); }
+        void reserve(size_t record_count, size_t payload_bytes);
+
+        // Copies the record's header and payload into the set.
+        void push_back(const HexRecordView& record);
+        // Moves every record of 'other' to the end of this set.
+        void append(HexRecordSet&& other);
+
+        // The view stays valid until the set is modified.
+        HexRecordView operator[](size_t index) const {
+            const Header& h = headers_[index];
+            return {h.byte_count, h.address, h.record_type, {arena_.data() + h.data_offset, h.byte_count}, h.checksum};
+        }
+
+        class const_iterator {
+            public:
+                const_iterator(const HexRecordSet* set, size_t index) : set_(set), index_(index) {}
+                HexRecordView operator*() const { return (*set_)[index_]; }
+                const_iterator& operator++() { ++index_; return *this; }
+                bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+            private:
+                const HexRecordSet* set_;
+                size_t index_;
+        };
+        const_iterator begin() const { return {this, 0}; }
+        const_iterator end() const { return {this, size()}; }
+
+    private:
+        struct Header {
+            uint64_t data_offset; // Offset of the payload in arena_; 64-bit, as merged inputs may pass 4 GiB
+            uint16_t address;
+            uint8_t byte_count;
+            uint8_t record_type;
+            uint8_t checksum;
+        };
+
+        std::vector<Header> headers_;
+        std::vector<uint8_t> arena_;
+};
+
+// Outcome of decoding one record. Everything except Ok and ChecksumMismatch
+// means the line was rejected and the output record is not usable.
+enum class HexStatus {
+    Ok,
+    NotARecord,       // Empty line or no leading ':'
+    InvalidCharacter, // A non-hex digit inside the record
+    TooShort,         // Fewer than the 5 mandatory bytes, or an odd digit count
+    LengthMismatch,   // Byte count field disagrees with the line length
+    ChecksumMismatch  // Fully decoded, but the checksum does not add up
+};
+
+// Decodes a trimmed record line into 'record' in a single pass using a nibble
+// lookup table. Never throws and never allocates beyond the payload itself.
+HexStatus decode_hex_record(const char* begin, const char* end, HexRecord& record);
+
+// Same as above, but decodes the payload into the caller's buffer (at least
+// 255 bytes) and describes the result as a view. Never allocates.
+HexStatus decode_hex_record(const char* begin, const char* end, HexRecordView& record, uint8_t* payload_buffer);
+
 // Parses a single line of text into a HexRecord.
 std::optional<HexRecord> parse_hex_record(const std::string& line);
 
+// Parses a single trimmed line in place, without copying it into a std::string.
+std::optional<HexRecord> parse_hex_record(const char* begin, const char* end);
+
+// Parses every record in an in-memory buffer holding the text of a HEX file.
+std::vector<HexRecord> parse_hex_buffer(const char* data, size_t size);
+
 // Parses an entire file and returns a vector of valid records.
+// The file is memory mapped and scanned in place.
 std::vector<HexRecord> parse_hex_file(const std::string& file_path);
 
+// Streaming API: calls visitor for every valid record in file order, without
+// ever building a std::vector<HexRecord>. Records with a bad checksum are
+// reported with a warning and still visited, like parse_hex_file does.
+using HexRecordVisitor = std::function<void(const HexRecordView&)>;
+void for_each_hex_record(const char* data, size_t size, const HexRecordVisitor& visitor);
+
+// Streams a whole file through the visitor. Returns false if it could not be opened.
+bool for_each_hex_record_in_file(const std::string& file_path, const HexRecordVisitor& visitor);
+
+// Parses a buffer or file into a HexRecordSet (no per-record allocations).
+// Large inputs are split into chunks at line boundaries and the chunks are
+// decoded on the shared thread pool. The records come back in file order,
+// exactly as the serial parser returns them. Progress is reported per
+// chunk; a cancelled parse returns no records. Small inputs are parsed
+// serially. thread_count == 0 uses every core.
+HexRecordSet parse_hex_record_set(const char* data, size_t size, unsigned thread_count = 0,
+                                  const ProgressCallback& progress = nullptr);
+HexRecordSet load_hex_record_set(const std::string& file_path, unsigned thread_count = 0,
+                                 const ProgressCallback& progress = nullptr);
+
+// The start address a 0x03 or 0x05 record sets, or std::nullopt for any
+// other record.
+std::optional<uint32_t> start_address_of(const HexRecordView& record);
+
+// The start address of a HEX file: CS * 16 + IP from a 0x03 record, or the
+// linear address from a 0x05 record. The last such record wins.
+std::optional<uint32_t> find_start_address(const HexRecordSet& records);
+
+// Which part of a raw binary file to load, and where it goes in memory.
+struct BinaryLoadOptions {
+    uint64_t file_offset = 0;                // First file byte to load
+    std::optional<uint64_t> length;          // Bytes to load; default is up to the end of the file
+    uint32_t base_address = 0;               // Address of the first loaded byte
+};
+
+// A read-only, zero-copy view of a window of a binary file. The file stays
+// mapped for as long as the view lives, and segment() points straight into
+// the mapping, so span-based analysis can run without copying the ROM.
+class BinaryView {
+    public:
+        BinaryView() = default;
+
+        // Maps the file and selects the window. Returns false if the file could
+        // not be opened or the offset lies past its end.
+        bool open(const std::string& file_path, const BinaryLoadOptions& options = {});
+
+        bool is_open() const { return file_.is_open(); }
+        const MemorySegment& segment() const { return segment_; }
+
+    private:
+        MappedFile file_;
+        MemorySegment segment_{0, 0, nullptr};
+};
+
+// Loads a window of a raw binary file into one contiguous region of a memory
+// image with a single bulk copy out of the mapped file.
+MemoryImage load_binary_image(const std::string& file_path, const BinaryLoadOptions& options = {});
+
 // A new funciton to parse raw binary files
-std::map<uint32_t, uint8_t> parse_binary_file(const std::string& file_path, uint32_t base_address);
+// Loads the file from 'base_address' onwards, placing each byte at its file offset.
+// Library API, kept for existing callers; the GUI and the batch tool load
+// dumps with load_rom_image(), or load_binary_image() for an explicit window.
+MemoryImage parse_binary_file(const std::string& file_path, uint32_t base_address);
+
+// Finds the offset of the first byte that is not 'fill' (0x00 for blank ROM,
+// 0xFF for erased flash). Returns 0 if the data is empty or all fill.
+uint32_t find_rom_start_offset(ByteSpan bytes, uint8_t fill = 0x00);
+uint32_t find_rom_start_offset(const std::string& file_path, uint8_t fill = 0x00);
+
+// One past the offset of the last byte that is not 'fill', or 0 if there is none.
+uint32_t find_rom_end_offset(ByteSpan bytes, uint8_t fill = 0x00);
+
+// The fill runs at the two ends of a ROM dump, in bytes.
+struct RomFillInfo {
+    uint32_t leading = 0;  // Before the first byte that is not fill; skipped when loading
+    uint32_t trailing = 0; // After the last byte that is not fill; loaded like the rest
+};
+
+// Maps a ROM dump once, skips its leading fill and loads the rest, up to the
+// end of the file, at its file offsets. Same result as find_rom_start_offset()
+// + parse_binary_file(), but the file is only opened and read once. 'fill_info',
+// if given, receives the length of both fill runs; a dump that is all fill
+// counts as trailing fill.
+MemoryImage load_rom_image(const std::string& file_path, uint8_t fill = 0x00, RomFillInfo* fill_info = nullptr);
+
+// Defining a enum filetype to open
+enum class FileType {
+    Unknown,
+    IntelHex,
+    RawBinary
+};
 
-// Finds the offset of the first non-zero byte in a file.
-uint32_t find_rom_start_offset(const std::string& file_path);
\ No newline at end of file
+// Sniffs the first 512 bytes of a file: text made only of hex digits, ':'
+// and whitespace is Intel HEX, anything else is treated as a raw binary.
+FileType detect_file_type(const std::string& file_path);
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include "MemoryImage.h"
+
+// How addresses above 64K are expressed in the output.
+enum class HexAddressMode {
+    Auto,    // Plain records below 64K, 0x04 records only where needed
+    Linear,  // 0x04 extended linear address records, full 32-bit range
+    Segment  // 0x02 extended segment address records, first 1 MB only
+};
+
+struct HexWriteOptions {
+    uint8_t record_size = 16;                            // Data bytes per record, 1..255 (16 and 32 are usual)
+    HexAddressMode address_mode = HexAddressMode::Auto;
+    std::optional<uint32_t> start_address;               // Adds a 0x05 record (0x03 CS:IP in segment mode)
+    bool crlf = false;                                   // "\r\n" line endings instead of "\n"
+};
+
+// Receives the encoded text in large blocks. Return false to stop.
+using HexTextSink = std::function<bool(const char* data, size_t size)>;
+
+// Encodes the image as Intel HEX: data records of up to record_size bytes
+// that never cross a 64K boundary, an address record whenever the upper
+// address changes, the optional start address and the EOF record. Bytes are
+// encoded with the table/SIMD encoder into a 1 MiB buffer that is handed to
+// the sink whenever it fills up. Returns false if the sink failed, the
+// record size is 0, or the image does not fit the address mode.
+bool encode_hex_image(const MemoryImage& memory, const HexWriteOptions& options, const HexTextSink& sink);
+
+// The whole encoding as one string, for small images.
+std::string hex_image_to_string(const MemoryImage& memory, const HexWriteOptions& options = {});
+
+// Writes the encoding to a file. Returns false if it could not be written.
+bool write_hex_file(const std::string& file_path, const MemoryImage& memory, const HexWriteOptions& options = {});
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "HexParser.h"
+#include "MemoryConflicts.h"
+#include "Symbols.h"
+#include "Disassembly.h"
+#include "CodeFlow.h"
+#include "Xrefs.h"
+
+// Everything derived from one input file. Built on the loader thread and
+// then shared read-only with the UI, so it is never modified after publishing.
+struct LoadedFile {
+    std::string filename;
+    FileType type = FileType::Unknown;
+    HexRecordSet records;
+    std::vector<MemoryConflict> conflicts; // Records writing the same addresses
+    MemoryImage memory;
+    RomFillInfo rom_fill; // Raw binaries: the fill runs at both ends
+    SymbolMap symbols;
+};
+
+// A finished job, ready to be swapped into the UI state in one go.
+struct LoadResult {
+    std::shared_ptr<const LoadedFile> file;
+    CpuType cpu;
+    std::vector<DisassembledInstruction> disassembly;
+    std::shared_ptr<const SymbolMap> symbols; // Labels for 'disassembly': the file's, or the flow analysis'
+    std::shared_ptr<const XrefIndex> xrefs;   // Who refers to each address, as listed in 'disassembly'
+};
+
+enum class LoadStage { Idle, Reading, Building, Symbols, Disassembling, CrossReferences };
+
+// Runs load -> build -> symbols -> disassembly -> cross references on a background thread so the
+// render thread never blocks. Only the latest request matters: starting a
+// new one cancels whatever is running, and a cancelled job never publishes.
+// Poll take_result() once per frame to pick up finished work.
+class LoadPipeline {
+    public:
+        LoadPipeline();
+        ~LoadPipeline();
+
+        LoadPipeline(const LoadPipeline&) = delete;
+        LoadPipeline& operator=(const LoadPipeline&) = delete;
+
+        // Loads and analyses a file from scratch.
+        void load(const std::string& file_path, const std::string& display_name, CpuType cpu,
+                  const CodeFlowOptions& flow = {});
+
+        // Re-runs only the disassembly of an already loaded file, e.g. after
+        // the CPU or the disassembly mode changed.
+        void disassemble(std::shared_ptr<const LoadedFile> file, CpuType cpu, const CodeFlowOptions& flow = {});
+
+        // Drops the running or queued job, if any.
+        void cancel();
+
+        bool busy() const { return busy_.load(); }
+        LoadStage stage() const { return stage_.load(); }
+        float progress() const { return progress_.load(); } // Fraction of the current stage
+        static const char* stage_name(LoadStage stage);
+
+        // The most recent finished job, handed over exactly once.
+        std::optional<LoadResult> take_result();
+
+    private:
+        struct Request {
+            uint64_t generation;
+            std::string file_path;
+            std::string display_name;
+            std::shared_ptr<const LoadedFile> file; // Set for disassembly-only jobs
+            CpuType cpu;
+            CodeFlowOptions flow;
+        };
+
+        void submit(Request request);
+        void worker_loop();
+        void run(const Request& request);
+        bool is_current(const Request& request) const { return generation_.load() == request.generation; }
+        void report(const Request& request, LoadStage stage, float progress);
+
+        std::thread worker_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::optional<Request> pending_;
+        std::optional<LoadResult> finished_;
+        bool stopping_ = false;
+
+        std::atomic<uint64_t> generation_{0};
+        std::atomic<bool> busy_{false};
+        std::atomic<LoadStage> stage_{LoadStage::Idle};
+        std::atomic<float> progress_{0.0f};
+};
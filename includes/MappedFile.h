@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+// A read-only view of a whole file mapped into memory.
+// Uses CreateFileMapping on Windows and mmap everywhere else, so the
+// parsers can scan the file contents in place instead of copying them
+// through a stream.
+class MappedFile {
+    public:
+        MappedFile() = default;
+        explicit MappedFile(const std::string& file_path) { open(file_path); }
+        ~MappedFile() { close(); }
+
+        // A mapping owns OS handles, so it can be moved but never copied.
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        // Maps the file. Returns false if it could not be opened or mapped.
+        // An empty file opens successfully with size() == 0.
+        bool open(const std::string& file_path);
+        void close();
+
+        bool is_open() const { return is_open_; }
+        const char* data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        void swap(MappedFile& other) noexcept;
+
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        bool is_open_ = false;
+#ifdef _WIN32
+        void* file_handle_ = nullptr;
+        void* mapping_handle_ = nullptr;
+#endif
+};
@@ -1,12 +1,34 @@
 #pragma once
 
 #include <cstdint>
-#include <map>
+#include <optional>
 #include <vector>
 #include "HexParser.h" // We need the HexRecord definition
+#include "MemoryImage.h"
+#include "Progress.h"
 
-// Define our memory map as a map from a 32-bit address to an 8-bit byte.
-using MemoryMap = std::map<uint32_t, uint8_t>;
+// This function processes a vector of HEX records and builds the final memory image.
+MemoryImage build_memory_map(const std::vector<HexRecord>& records);
+MemoryImage build_memory_map(const HexRecordSet& records);
 
-// This function processes a vector of HEX records and builds the final memory map.
-MemoryMap build_memory_map(const std::vector<HexRecord>& records);
+// What the fused loader saw besides the data.
+struct HexLoadInfo {
+    bool opened = false;                  // The file could be read
+    size_t records = 0;                   // Valid records of any type
+    std::optional<uint32_t> start_address; // From the last 0x03/0x05 record
+};
+
+// Fused parse + build: streams the HEX text straight into the memory image
+// without materializing any HexRecord, so peak memory is about the final image.
+// 'info', if given, receives the record count and the start address.
+MemoryImage build_memory_map_from_buffer(const char* data, size_t size, HexLoadInfo* info = nullptr);
+MemoryImage load_hex_memory_map(const std::string& file_path, HexLoadInfo* info = nullptr);
+
+// Same result as build_memory_map, built on the shared thread pool. Each
+// chunk's starting 0x02/0x04 address is resolved with a cheap prefix pass
+// and the partial images are merged in record order. Progress is reported
+// per chunk; a cancelled build returns an empty image.
+MemoryImage build_memory_map_parallel(const std::vector<HexRecord>& records, unsigned thread_count = 0,
+                                      const ProgressCallback& progress = nullptr);
+MemoryImage build_memory_map_parallel(const HexRecordSet& records, unsigned thread_count = 0,
+                                      const ProgressCallback& progress = nullptr);
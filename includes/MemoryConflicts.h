@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "HexParser.h"
+
+// Identifies a data record: which input (e.g. bootloader = 0, application = 1)
+// and its index within that input's HexRecordSet.
+struct RecordRef {
+    uint32_t input;
+    uint32_t record;
+};
+
+// Two data records that write the same address range. When the inputs are
+// applied in order, 'later' overwrites 'earlier' there.
+struct MemoryConflict {
+    uint32_t address;  // First overlapping address
+    uint32_t length;   // Number of overlapping bytes
+    RecordRef earlier;
+    RecordRef later;
+    bool identical;    // True if both records hold the same bytes in the overlap
+};
+
+// Finds every pair of data records, across all inputs, whose resolved
+// address ranges overlap. 0x02/0x04 records are tracked per input. Built on
+// an interval tree over the records, so the cost is O(n log n + conflicts)
+// rather than per byte. Results are sorted by address.
+std::vector<MemoryConflict> find_memory_conflicts(const std::vector<const HexRecordSet*>& inputs);
+std::vector<MemoryConflict> find_memory_conflicts(const HexRecordSet& records);
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "ByteSpan.h"
+
+// A maximal run of consecutive present addresses, with its bytes.
+struct MemorySegment {
+    uint32_t start;
+    size_t length;
+    const uint8_t* data; // 'length' contiguous bytes; valid until the image is modified
+
+    uint64_t end() const { return uint64_t(start) + length; } // One past the last address
+    ByteSpan bytes() const { return {data, length}; }
+};
+
+// A sparse image of the full 32-bit address space.
+//
+// The image is stored as 4 KiB pages of flat bytes, each with a presence
+// bitmap that records which bytes were actually written. A two-level page
+// directory (1024 x 1024 pages) maps an address to its page in O(1).
+// Directory leaves are only allocated for the 4 MiB regions that are used,
+// so a 1 MB ROM costs about 1 MB of RAM.
+//
+// Page storage is one arena of page-sized slots kept in address order, so
+// every run of consecutive present bytes is also contiguous in memory.
+// Writes that create a page below an existing one append its slot out of
+// order; compact() sorts the slots again, and the segment accessors need a
+// compacted image. Const methods never change the storage, so a finished
+// image can be read from several threads at once. Next
+// to the pages the image keeps a sorted, coalesced list of extents, which
+// answers "which regions exist" without touching the bytes: segment
+// iteration, O(log n) lookup of the segment holding an address, and gap
+// skipping.
+class MemoryImage {
+    public:
+        static constexpr uint32_t kPageBits = 12;
+        static constexpr uint32_t kPageSize = 1u << kPageBits;
+
+        MemoryImage() = default;
+        MemoryImage(MemoryImage&&) noexcept = default;
+        MemoryImage& operator=(MemoryImage&&) noexcept = default;
+        MemoryImage(const MemoryImage&) = delete;
+        MemoryImage& operator=(const MemoryImage&) = delete;
+
+        // Number of bytes present in the image.
+        size_t size() const { return byte_count_; }
+        bool empty() const { return byte_count_ == 0; }
+        size_t page_count() const { return present_.size(); }
+        size_t segment_count() const { return extents_.size(); }
+        void clear();
+
+        bool contains(uint32_t address) const {
+            uint32_t slot = find_slot(address >> kPageBits);
+            return slot != kNoSlot && test_bit(slot, address & (kPageSize - 1));
+        }
+
+        std::optional<uint8_t> read(uint32_t address) const {
+            uint32_t slot = find_slot(address >> kPageBits);
+            uint32_t offset = address & (kPageSize - 1);
+            if (slot == kNoSlot || !test_bit(slot, offset)) {
+                return std::nullopt;
+            }
+            return bytes_[static_cast<size_t>(slot) * kPageSize + offset];
+        }
+
+        // Reads a byte, returning 'fill' for addresses that were never written.
+        uint8_t read_or(uint32_t address, uint8_t fill) const {
+            return read(address).value_or(fill);
+        }
+
+        void write(uint32_t address, uint8_t value);
+
+        // Writes 'length' bytes starting at 'address' with one copy per page,
+        // setting the presence bits a word at a time. Blocks may straddle page
+        // and 64K boundaries; addresses past 0xFFFFFFFF wrap to 0 like write().
+        void write_block(uint32_t address, const uint8_t* data, size_t length);
+
+        // Lowest and highest present address. Both are 0 for an empty image.
+        uint32_t min_address() const { return empty() ? 0 : min_address_; }
+        uint32_t max_address() const { return max_address_; }
+
+        // First present address at or above 'address'. O(log segments).
+        std::optional<uint32_t> next_present(uint32_t address) const;
+
+        // All segments in address order. Throws std::logic_error if the image
+        // needs compact() first.
+        std::vector<MemorySegment> segments() const;
+
+        // The segment containing 'address', found by binary search. Throws
+        // std::logic_error if the image needs compact() first.
+        std::optional<MemorySegment> find_segment(uint32_t address) const;
+
+        // Puts the page slots back in address order after out-of-order writes.
+        // Whoever builds an image calls this once the writes are done; it is
+        // free when the pages were written in order.
+        void compact();
+        bool is_compact() const { return in_order_; }
+
+        // The run of present bytes starting at 'address', up to the end of its page.
+        // Empty if 'address' is not present.
+        ByteSpan span_at(uint32_t address) const;
+
+        // Copies every present byte of 'other' over this image (other wins).
+        void overlay(const MemoryImage& other);
+
+        // Walks the present bytes in address order as (address, value) pairs.
+        class const_iterator {
+            public:
+                using value_type = std::pair<uint32_t, uint8_t>;
+
+                const_iterator() = default;
+                const_iterator(const MemoryImage* image, std::optional<uint32_t> address);
+
+                const value_type& operator*() const { return current_; }
+                const value_type* operator->() const { return &current_; }
+                const_iterator& operator++();
+                bool operator==(const const_iterator& other) const { return at_end_ == other.at_end_ && (at_end_ || current_.first == other.current_.first); }
+                bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+            private:
+                const MemoryImage* image_ = nullptr;
+                value_type current_{0, 0};
+                bool at_end_ = true;
+                const uint8_t* run_ = nullptr; // Remaining bytes of the current page run
+                size_t run_left_ = 0;
+        };
+
+        const_iterator begin() const { return {this, empty() ? std::nullopt : std::optional<uint32_t>(min_address_)}; }
+        const_iterator end() const { return {this, std::nullopt}; }
+
+    private:
+        static constexpr uint32_t kLeafBits = 10;
+        static constexpr uint32_t kLeafSize = 1u << kLeafBits;
+        static constexpr uint32_t kNoSlot = 0xFFFFFFFF;
+
+        using PageBits = std::array<uint64_t, kPageSize / 64>;
+        using Leaf = std::array<uint32_t, kLeafSize>;
+
+        struct Extent {
+            uint32_t start;
+            size_t length;
+            uint64_t end() const { return uint64_t(start) + length; }
+        };
+
+        uint32_t find_slot(uint32_t page) const {
+            uint32_t top = page >> kLeafBits;
+            if (top >= directory_.size() || !directory_[top]) {
+                return kNoSlot;
+            }
+            return (*directory_[top])[page & (kLeafSize - 1)];
+        }
+
+        bool test_bit(uint32_t slot, uint32_t offset) const {
+            return (present_[slot][offset >> 6] >> (offset & 63)) & 1;
+        }
+
+        uint32_t get_or_create_slot(uint32_t page);
+        void require_compact() const;
+        void add_extent(uint32_t start, size_t length);
+        std::vector<Extent>::const_iterator extent_at_or_after(uint32_t address) const;
+        MemorySegment make_segment(const Extent& extent) const;
+
+        std::vector<std::unique_ptr<Leaf>> directory_; // Indexed by page >> kLeafBits
+        std::vector<uint8_t> bytes_;                   // kPageSize bytes per slot
+        std::vector<PageBits> present_;                // One presence bitmap per slot
+        std::vector<uint32_t> slot_page_;              // Page number held by each slot
+        bool in_order_ = true;                         // Slots sorted by page number
+        std::vector<Extent> extents_;                  // Sorted and coalesced
+        size_t byte_count_ = 0;
+        uint32_t min_address_ = 0xFFFFFFFF;
+        uint32_t max_address_ = 0;
+};
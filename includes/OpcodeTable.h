@@ -0,0 +1,281 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Every distinct 8080/8085 mnemonic.
+enum class Mnemonic : uint8_t {
+    Unknown,
+    NOP, LXI, STAX, INX, INR, DCR, MVI, RLC, DAD, LDAX, DCX, RRC, RAL, RAR,
+    SHLD, DAA, LHLD, CMA, STA, STC, LDA, CMC, MOV, HLT,
+    ADD, ADC, SUB, SBB, ANA, XRA, ORA, CMP,
+    RNZ, RZ, RNC, RC, RPO, RPE, RP, RM, RET,
+    JNZ, JZ, JNC, JC, JPO, JPE, JP, JM, JMP,
+    CNZ, CZ, CNC, CC, CPO, CPE, CP, CM, CALL,
+    POP, PUSH, ADI, ACI, SUI, SBI, ANI, XRI, ORI, CPI, RST,
+    OUT, IN, XTHL, PCHL, XCHG, DI, SPHL, EI,
+    RIM, SIM, // 8085 only
+    Count
+};
+
+inline constexpr const char* mnemonic_names[] = {
+    "???",
+    "NOP", "LXI", "STAX", "INX", "INR", "DCR", "MVI", "RLC", "DAD", "LDAX", "DCX", "RRC", "RAL", "RAR",
+    "SHLD", "DAA", "LHLD", "CMA", "STA", "STC", "LDA", "CMC", "MOV", "HLT",
+    "ADD", "ADC", "SUB", "SBB", "ANA", "XRA", "ORA", "CMP",
+    "RNZ", "RZ", "RNC", "RC", "RPO", "RPE", "RP", "RM", "RET",
+    "JNZ", "JZ", "JNC", "JC", "JPO", "JPE", "JP", "JM", "JMP",
+    "CNZ", "CZ", "CNC", "CC", "CPO", "CPE", "CP", "CM", "CALL",
+    "POP", "PUSH", "ADI", "ACI", "SUI", "SBI", "ANI", "XRI", "ORI", "CPI", "RST",
+    "OUT", "IN", "XTHL", "PCHL", "XCHG", "DI", "SPHL", "EI",
+    "RIM", "SIM",
+};
+static_assert(sizeof(mnemonic_names) / sizeof(mnemonic_names[0]) == static_cast<size_t>(Mnemonic::Count),
+              "mnemonic_names must list every Mnemonic");
+
+// What follows the opcode byte, and how it is shown.
+enum class OperandKind : uint8_t {
+    None,
+    Imm8,    // "#$XX"
+    Imm16,   // "#$XXXX"
+    Addr16,  // "$XXXX", a data address
+    Target16 // A code address: its label if there is one, else "$XXXX"
+};
+
+// How an instruction affects the program counter.
+enum class FlowType : uint8_t {
+    Sequential,
+    Jump,           // JMP a16
+    CondJump,       // Jcc a16
+    Call,           // CALL a16
+    CondCall,       // Ccc a16
+    Return,         // RET
+    CondReturn,     // Rcc
+    Restart,        // RST n, a call to n * 8
+    IndirectJump,   // PCHL
+    Halt            // HLT
+};
+
+// Everything the tools need to know about one opcode, decided at compile time.
+struct OpcodeInfo {
+    char text[12];        // Fixed part of the listing text, e.g. "MOV  B,C" or "MVI  B, "
+    uint8_t text_length;  // Characters used in 'text'
+    Mnemonic mnemonic;
+    uint8_t size;         // 1, 2 or 3 bytes
+    OperandKind operand;
+    FlowType flow;
+    uint8_t cycles;       // States when a conditional branch is not taken
+    uint8_t cycles_taken; // States when it is taken (same as 'cycles' otherwise)
+    bool undocumented;    // Shown with a '*', like "NOP*"
+
+    // True if the operand is a code address that deserves a label.
+    constexpr bool has_code_target() const {
+        return operand == OperandKind::Target16;
+    }
+};
+
+using OpcodeTable = std::array<OpcodeInfo, 256>;
+
+namespace opcode_table_detail {
+
+inline constexpr const char* registers[] = {"B", "C", "D", "E", "H", "L", "M", "A"};
+inline constexpr const char* register_pairs[] = {"B", "D", "H", "SP"};
+
+// Appends 'src' to the entry's text.
+constexpr void append(OpcodeInfo& info, const char* src) {
+    while (*src) {
+        info.text[info.text_length++] = *src++;
+    }
+}
+
+// Builds one entry. 'width' pads the mnemonic with spaces (the listing
+// aligns most operands at column 5; ADD and friends use a single space).
+constexpr OpcodeInfo op(Mnemonic mnemonic, uint8_t size, uint8_t cycles, const char* operands = "",
+                        OperandKind operand = OperandKind::None, FlowType flow = FlowType::Sequential,
+                        uint8_t cycles_taken = 0, bool undocumented = false, int width = 5) {
+    OpcodeInfo info{};
+    append(info, mnemonic_names[static_cast<int>(mnemonic)]);
+    if (undocumented) {
+        append(info, "*");
+    }
+    if (*operands || operand != OperandKind::None) {
+        do {
+            info.text[info.text_length++] = ' ';
+        } while (info.text_length < width);
+        append(info, operands);
+    }
+    info.mnemonic = mnemonic;
+    info.size = size;
+    info.operand = operand;
+    info.flow = flow;
+    info.cycles = cycles;
+    info.cycles_taken = cycles_taken ? cycles_taken : cycles;
+    info.undocumented = undocumented;
+    return info;
+}
+
+constexpr OpcodeTable make_8080_table() {
+    OpcodeTable t{};
+    for (auto& entry : t) {
+        entry = op(Mnemonic::Unknown, 1, 4);
+    }
+
+    // 00-3F: loads, increments, rotates and the 16-bit group.
+    for (int rp = 0; rp < 4; ++rp) {
+        int base = rp << 4;
+        // The operand text of LXI is completed by the immediate: "LXI  B, #$1234".
+        OpcodeInfo lxi = op(Mnemonic::LXI, 3, 10, "", OperandKind::Imm16);
+        append(lxi, register_pairs[rp]);
+        append(lxi, ", ");
+        t[base | 0x01] = lxi;
+        t[base | 0x03] = op(Mnemonic::INX, 1, 5, register_pairs[rp]);
+        t[base | 0x09] = op(Mnemonic::DAD, 1, 10, register_pairs[rp]);
+        t[base | 0x0B] = op(Mnemonic::DCX, 1, 5, register_pairs[rp]);
+    }
+    t[0x02] = op(Mnemonic::STAX, 1, 7, "B");
+    t[0x12] = op(Mnemonic::STAX, 1, 7, "D");
+    t[0x0A] = op(Mnemonic::LDAX, 1, 7, "B");
+    t[0x1A] = op(Mnemonic::LDAX, 1, 7, "D");
+    t[0x22] = op(Mnemonic::SHLD, 3, 16, "", OperandKind::Addr16);
+    t[0x2A] = op(Mnemonic::LHLD, 3, 16, "", OperandKind::Addr16);
+    t[0x32] = op(Mnemonic::STA, 3, 13, "", OperandKind::Addr16);
+    t[0x3A] = op(Mnemonic::LDA, 3, 13, "", OperandKind::Addr16);
+
+    for (int r = 0; r < 8; ++r) {
+        bool memory = r == 6;
+        t[(r << 3) | 0x04] = op(Mnemonic::INR, 1, memory ? 10 : 5, registers[r]);
+        t[(r << 3) | 0x05] = op(Mnemonic::DCR, 1, memory ? 10 : 5, registers[r]);
+        OpcodeInfo mvi = op(Mnemonic::MVI, 2, memory ? 10 : 7, "", OperandKind::Imm8);
+        append(mvi, registers[r]);
+        append(mvi, ", ");
+        t[(r << 3) | 0x06] = mvi;
+    }
+
+    t[0x00] = op(Mnemonic::NOP, 1, 4);
+    for (int opcode : {0x08, 0x10, 0x18, 0x20, 0x28, 0x30, 0x38}) {
+        t[opcode] = op(Mnemonic::NOP, 1, 4, "", OperandKind::None, FlowType::Sequential, 0, true);
+    }
+    t[0x07] = op(Mnemonic::RLC, 1, 4);
+    t[0x0F] = op(Mnemonic::RRC, 1, 4);
+    t[0x17] = op(Mnemonic::RAL, 1, 4);
+    t[0x1F] = op(Mnemonic::RAR, 1, 4);
+    t[0x27] = op(Mnemonic::DAA, 1, 4);
+    t[0x2F] = op(Mnemonic::CMA, 1, 4);
+    t[0x37] = op(Mnemonic::STC, 1, 4);
+    t[0x3F] = op(Mnemonic::CMC, 1, 4);
+
+    // 40-7F: MOV r1,r2, with HLT where MOV M,M would be.
+    for (int opcode = 0x40; opcode <= 0x7F; ++opcode) {
+        int dst = (opcode >> 3) & 0x07;
+        int src = opcode & 0x07;
+        OpcodeInfo mov = op(Mnemonic::MOV, 1, (dst == 6 || src == 6) ? 7 : 5, registers[dst]);
+        append(mov, ",");
+        append(mov, registers[src]);
+        t[opcode] = mov;
+    }
+    t[0x76] = op(Mnemonic::HLT, 1, 7, "", OperandKind::None, FlowType::Halt);
+
+    // 80-BF: register arithmetic; C6-FE: the immediate forms.
+    const Mnemonic arithmetic[] = {Mnemonic::ADD, Mnemonic::ADC, Mnemonic::SUB, Mnemonic::SBB,
+                                   Mnemonic::ANA, Mnemonic::XRA, Mnemonic::ORA, Mnemonic::CMP};
+    const Mnemonic immediate[] = {Mnemonic::ADI, Mnemonic::ACI, Mnemonic::SUI, Mnemonic::SBI,
+                                  Mnemonic::ANI, Mnemonic::XRI, Mnemonic::ORI, Mnemonic::CPI};
+    for (int opcode = 0x80; opcode <= 0xBF; ++opcode) {
+        int src = opcode & 0x07;
+        t[opcode] = op(arithmetic[(opcode >> 3) & 0x07], 1, src == 6 ? 7 : 4, registers[src],
+                       OperandKind::None, FlowType::Sequential, 0, false, 0);
+    }
+    for (int i = 0; i < 8; ++i) {
+        t[0xC6 | (i << 3)] = op(immediate[i], 2, 7, "", OperandKind::Imm8, FlowType::Sequential, 0, false, 0);
+    }
+
+    // C0-FF: branches by condition (NZ, Z, NC, C, PO, PE, P, M), then the rest.
+    const Mnemonic returns[] = {Mnemonic::RNZ, Mnemonic::RZ, Mnemonic::RNC, Mnemonic::RC,
+                                Mnemonic::RPO, Mnemonic::RPE, Mnemonic::RP, Mnemonic::RM};
+    const Mnemonic jumps[] = {Mnemonic::JNZ, Mnemonic::JZ, Mnemonic::JNC, Mnemonic::JC,
+                              Mnemonic::JPO, Mnemonic::JPE, Mnemonic::JP, Mnemonic::JM};
+    const Mnemonic calls[] = {Mnemonic::CNZ, Mnemonic::CZ, Mnemonic::CNC, Mnemonic::CC,
+                              Mnemonic::CPO, Mnemonic::CPE, Mnemonic::CP, Mnemonic::CM};
+    const char* rst_numbers[] = {"0", "1", "2", "3", "4", "5", "6", "7"};
+    for (int cc = 0; cc < 8; ++cc) {
+        int base = 0xC0 | (cc << 3);
+        t[base | 0x00] = op(returns[cc], 1, 5, "", OperandKind::None, FlowType::CondReturn, 11);
+        t[base | 0x02] = op(jumps[cc], 3, 10, "", OperandKind::Target16, FlowType::CondJump);
+        t[base | 0x04] = op(calls[cc], 3, 11, "", OperandKind::Target16, FlowType::CondCall, 17);
+        t[base | 0x07] = op(Mnemonic::RST, 1, 11, rst_numbers[cc], OperandKind::None, FlowType::Restart);
+    }
+    for (int rp = 0; rp < 4; ++rp) {
+        const char* name = rp == 3 ? "PSW" : register_pairs[rp];
+        t[0xC1 | (rp << 4)] = op(Mnemonic::POP, 1, 10, name);
+        t[0xC5 | (rp << 4)] = op(Mnemonic::PUSH, 1, 11, name);
+    }
+    t[0xC3] = op(Mnemonic::JMP, 3, 10, "", OperandKind::Target16, FlowType::Jump);
+    t[0xC9] = op(Mnemonic::RET, 1, 10, "", OperandKind::None, FlowType::Return);
+    t[0xD9] = op(Mnemonic::RET, 1, 10, "", OperandKind::None, FlowType::Return, 0, true);
+    t[0xCD] = op(Mnemonic::CALL, 3, 17, "", OperandKind::Target16, FlowType::Call);
+    for (int opcode : {0xDD, 0xED, 0xFD}) {
+        t[opcode] = op(Mnemonic::CALL, 3, 17, "", OperandKind::Target16, FlowType::Call, 0, true);
+    }
+    t[0xD3] = op(Mnemonic::OUT, 2, 10, "", OperandKind::Imm8);
+    t[0xDB] = op(Mnemonic::IN, 2, 10, "", OperandKind::Imm8);
+    t[0xE3] = op(Mnemonic::XTHL, 1, 18);
+    t[0xE9] = op(Mnemonic::PCHL, 1, 5, "", OperandKind::None, FlowType::IndirectJump);
+    t[0xEB] = op(Mnemonic::XCHG, 1, 4);
+    t[0xF3] = op(Mnemonic::DI, 1, 4);
+    t[0xF9] = op(Mnemonic::SPHL, 1, 5);
+    t[0xFB] = op(Mnemonic::EI, 1, 4);
+    return t;
+}
+
+// The 8085 adds RIM and SIM in two of the 8080's spare NOP slots and
+// changes the state counts of a handful of instructions.
+constexpr OpcodeTable make_8085_table() {
+    OpcodeTable t = make_8080_table();
+    t[0x20] = op(Mnemonic::RIM, 1, 4);
+    t[0x30] = op(Mnemonic::SIM, 1, 4);
+    for (int opcode = 0; opcode < 256; ++opcode) {
+        OpcodeInfo& info = t[opcode];
+        switch (info.mnemonic) {
+            case Mnemonic::MOV: case Mnemonic::INR: case Mnemonic::DCR:
+                if (info.cycles == 5) info.cycles = info.cycles_taken = 4;
+                break;
+            case Mnemonic::INX: case Mnemonic::DCX: case Mnemonic::PCHL: case Mnemonic::SPHL:
+                info.cycles = info.cycles_taken = 6;
+                break;
+            case Mnemonic::PUSH: case Mnemonic::RST:
+                info.cycles = info.cycles_taken = 12;
+                break;
+            case Mnemonic::CALL:
+                info.cycles = info.cycles_taken = 18;
+                break;
+            case Mnemonic::XTHL:
+                info.cycles = info.cycles_taken = 16;
+                break;
+            case Mnemonic::HLT:
+                info.cycles = info.cycles_taken = 5;
+                break;
+            default:
+                if (info.flow == FlowType::CondJump) {
+                    info.cycles = 7;
+                } else if (info.flow == FlowType::CondCall) {
+                    info.cycles = 9;
+                    info.cycles_taken = 18;
+                } else if (info.flow == FlowType::CondReturn) {
+                    info.cycles = 6;
+                    info.cycles_taken = 12;
+                }
+                break;
+        }
+    }
+    return t;
+}
+
+} // namespace opcode_table_detail
+
+// One descriptor per opcode, shared by the disassemblers, the symbol scanner
+// and any other analysis, so sizes and branch targets always agree.
+inline constexpr OpcodeTable opcodes_8080 = opcode_table_detail::make_8080_table();
+inline constexpr OpcodeTable opcodes_8085 = opcode_table_detail::make_8085_table();
+
+static_assert(opcodes_8080[0xC3].size == 3 && opcodes_8080[0xC3].flow == FlowType::Jump, "JMP");
+static_assert(opcodes_8080[0x3E].size == 2 && opcodes_8080[0x76].flow == FlowType::Halt, "MVI A / HLT");
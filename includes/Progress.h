@@ -0,0 +1,7 @@
+#pragma once
+
+#include <functional>
+
+// Called now and then during long runs with the fraction done (0..1).
+// Returning false stops the run early; what it returns is then incomplete.
+using ProgressCallback = std::function<bool(float)>;
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <ostream>
+#include <string>
+#include "Symbols.h"
+
+// Symbol file layouts written by 8080/8085 toolchains.
+enum class SymbolFileFormat {
+    Auto,    // Chosen from the file extension: .sym, .map, .lst/.prn, anything else is Equates
+    CpmSym,  // CP/M MAC/RMAC/LINK-80 ".SYM": "0100 START" pairs, several per line
+    Equates, // "START EQU 0100H" or "START = $0100", possibly among lines of code
+    Map,     // A linker map: "START 0100 LOOP 0103" pairs, and equates
+    Listing  // An assembler listing: "0100 C3 10 01  START: JMP LOOP"
+};
+
+// The format 'file_path' is read or written in when Auto is asked for.
+SymbolFileFormat symbol_format_for_path(const std::string& file_path);
+
+// Parses symbol text in place and names the addresses in 'symbols'. The
+// text is tokenized in a single pass with no allocation per line or token:
+// names stay views into the text until the table interns them, in one
+// sort and merge at the end. Imported names win over generated "Lxxxx"
+// labels and over earlier names at the same address. Lines that do not
+// parse are skipped. Returns the number of symbols read. Auto reads the
+// text as Equates, since there is no file name to go by.
+//
+// Numbers may be written 0100H, 0x0100, $0100 or 0100. A bare number is
+// hex, except after EQU/SET/= in an equate, where it is decimal as in the
+// assemblers (MAC, M80, ASM).
+//
+// Equates files are often assembler source, so a bare "START 0100" pair
+// is only read from one on a line of its own starting in column 0, with
+// the number written as an address; Map reads pairs anywhere.
+//
+// A listing may start its lines with a line number. Whether it does is
+// taken from its first line with code bytes; in a listing without any, a
+// label on a line with no code bytes is skipped rather than guessed.
+size_t import_symbols(const char* data, size_t size, SymbolFileFormat format, SymbolMap& symbols);
+
+// Maps the file and imports it. Returns std::nullopt if it could not be
+// opened, else the number of symbols read.
+std::optional<size_t> import_symbol_file(const std::string& file_path, SymbolMap& symbols,
+                                         SymbolFileFormat format = SymbolFileFormat::Auto);
+
+// Writes every label in address order: "0100 START" lines for CpmSym,
+// "START\tEQU\t0100H" lines for Equates (Map and Listing write Equates too).
+void export_symbols(std::ostream& out, const SymbolMap& symbols, SymbolFileFormat format);
+
+// Writes the labels to a file. Returns false if it could not be written.
+bool export_symbol_file(const std::string& file_path, const SymbolMap& symbols,
+                        SymbolFileFormat format = SymbolFileFormat::Auto);
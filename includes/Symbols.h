@@ -1,11 +1,85 @@
 #pragma once
 
-#include "Memory.h" // For MemoryMap
+#include "Memory.h" // For MemoryImage
+#include "Progress.h"
+#include <cstdint>
 #include <string>
-#include <map>
+#include <string_view>
+#include <utility>
+#include <vector>
 
-// A map from a 32-bit address to its string label (e.g., 0x401A -> "L401A")
-using SymbolMap = std::map<uint32_t, std::string>;
+// A map from a 32-bit address to its label (e.g., 0x401A -> "L401A").
+//
+// Labels are kept as a flat vector of 8-byte entries sorted by address, so a
+// lookup is one binary search. Generated "Lxxxx" labels store no text at
+// all: the name is formatted from the address when it is shown. Any other
+// name is interned once in a string pool shared by all labels.
+class SymbolMap {
+    public:
+        // One label: its address, and the pool offset of its name.
+        struct Symbol {
+            uint32_t address;
+            uint32_t name; // kGeneratedName for an "Lxxxx" label
+        };
+        static constexpr uint32_t kGeneratedName = 0xFFFFFFFF;
 
-// Scans the memory and generates a map of all identified labels.
-SymbolMap generate_symbols(const MemoryMap& memory);
\ No newline at end of file
+        size_t size() const { return symbols_.size(); }
+        bool empty() const { return symbols_.empty(); }
+        void clear();
+        void reserve(size_t count) { symbols_.reserve(count); }
+
+        // In address order.
+        const Symbol* begin() const { return symbols_.data(); }
+        const Symbol* end() const { return symbols_.data() + symbols_.size(); }
+
+        // Adds an "Lxxxx" label at 'address' unless it already has a label.
+        // Adding in address order appends without moving anything.
+        void add_generated(uint32_t address);
+
+        // Gives 'address' the label 'name', replacing any label it had.
+        void add(uint32_t address, std::string_view name);
+
+        // Names many addresses in one sort and merge instead of one insert
+        // each, e.g. a whole symbol file. Each name replaces the label its
+        // address had; if an address repeats, its last name wins.
+        void add_all(const std::vector<std::pair<uint32_t, std::string_view>>& names);
+
+        // Adds every label of 'other'. Its names win over the labels here,
+        // and its generated labels only fill addresses that have none.
+        void merge(const SymbolMap& other);
+
+        // The label at 'address', or nullptr.
+        const Symbol* find(uint32_t address) const;
+        bool contains(uint32_t address) const { return find(address) != nullptr; }
+
+        // Writes the label's name into [first, last) like std::to_chars:
+        // returns one past the last character, with no terminating NUL.
+        char* format_name(char* first, char* last, const Symbol& symbol) const;
+        std::string name(const Symbol& symbol) const;
+
+    private:
+        // Where 'address' is or would go.
+        std::vector<Symbol>::iterator position(uint32_t address);
+        // Merges entries sorted by address, one per address, into symbols_.
+        // Named entries replace a label already there; generated ones do not.
+        void merge_sorted(const std::vector<Symbol>& entries);
+        uint32_t intern(std::string_view name);
+        // Grows the intern table to take 'count' more names without a rehash.
+        void reserve_names(size_t count);
+        std::string_view pooled(uint32_t offset) const;
+
+        std::vector<Symbol> symbols_;
+        std::string pool_;                // Interned names, each followed by a NUL
+        std::vector<uint32_t> intern_;    // Open-addressing table of pool offsets + 1 (0 = empty)
+        size_t interned_ = 0;
+};
+
+class CodeMap;
+
+// Scans the memory and generates a map of all identified labels. Progress
+// is reported every megabyte scanned; a cancelled scan returns no labels.
+SymbolMap generate_symbols(const MemoryImage& memory, const ProgressCallback& progress = nullptr);
+
+// Labels for the branch targets of the code found by analyze_code_flow,
+// so bytes that are only data never produce labels.
+SymbolMap generate_symbols(const CodeMap& code);
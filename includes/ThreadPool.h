@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads pulling jobs from a shared queue.
+// Used to spread the heavy parsing/building work across all cores.
+class ThreadPool {
+    public:
+        // thread_count == 0 means one worker per hardware thread.
+        explicit ThreadPool(unsigned thread_count = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+        // Queues a job and returns a future for its result.
+        template <typename F>
+        auto submit(F&& job) -> std::future<decltype(job())> {
+            using Result = decltype(job());
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+            std::future<Result> result = task->get_future();
+            enqueue([task]() { (*task)(); });
+            return result;
+        }
+
+        // Runs task(0) .. task(count - 1) on the pool and waits for all of them.
+        // The first exception thrown by a task is rethrown here.
+        void parallel_for(size_t count, const std::function<void(size_t)>& task);
+
+        // A process-wide pool sized to the machine, created on first use.
+        static ThreadPool& shared();
+
+    private:
+        void enqueue(std::function<void()> job);
+        void worker_loop();
+
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> jobs_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stopping_ = false;
+};
+
+// Resolves a user supplied thread count: 0 means "all hardware threads".
+unsigned resolve_thread_count(unsigned requested);
+
+// Runs task(index, worker) for index 0 .. count - 1 on 'thread_count' threads
+// of its own and waits for all of them. Every worker starts with its own
+// deque of indices and, once that is empty, steals from the back of the
+// others, so a few slow items do not leave the other threads idle. Meant for
+// coarse, uneven jobs such as whole files. Tasks may use the shared pool,
+// since they never run on it. The first exception thrown is rethrown here.
+void work_stealing_for(size_t count, unsigned thread_count, const std::function<void(size_t, unsigned)>& task);
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "Memory.h"
+#include "Symbols.h"
+#include "Disassembly.h"
+
+// How an instruction refers to an address.
+enum class XrefKind : uint8_t {
+    Call,   // CALL, Ccc and RST
+    Jump,   // JMP and Jcc
+    Read,   // LDA and LHLD
+    Write,  // STA and SHLD
+    Address // LXI: the address is loaded into a register pair
+};
+
+// One reference: the instruction at 'from' refers to the row's address.
+struct Xref {
+    uint32_t from;
+    XrefKind kind;
+};
+
+// The references to one address, in source address order.
+struct XrefList {
+    const Xref* first = nullptr;
+    const Xref* last = nullptr;
+
+    const Xref* begin() const { return first; }
+    const Xref* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+};
+
+// Who refers to every address, in compressed sparse row form. 8080/8085
+// operands are 16 bits, so there is one row per address of the 64K space:
+// row A is refs_[offsets_[A], offsets_[A + 1]). Finding the references to
+// an address is two array reads, and the references themselves sit side
+// by side in one vector.
+class XrefIndex {
+    public:
+        static constexpr uint32_t kAddressCount = 0x10000;
+
+        XrefList refs_to(uint32_t address) const {
+            if (offsets_.empty() || address >= kAddressCount) {
+                return {};
+            }
+            return {refs_.data() + offsets_[address], refs_.data() + offsets_[address + 1]};
+        }
+        size_t count(uint32_t address) const { return refs_to(address).size(); }
+
+        // All references, ordered by target and then by source.
+        size_t size() const { return refs_.size(); }
+        bool empty() const { return refs_.empty(); }
+
+    private:
+        friend XrefIndex build_xrefs(const MemoryImage& memory, const std::vector<DisassembledInstruction>& disassembly,
+                                     CpuType cpu);
+
+        std::vector<uint32_t> offsets_; // kAddressCount + 1 row starts, or empty
+        std::vector<Xref> refs_;
+};
+
+// Indexes the references made by the instructions of a listing, so the
+// index always agrees with what is shown: with the linear sweep every
+// decoded instruction counts, with follow-flow only the code it found.
+// Data lines and instructions whose operand is missing from the image are
+// skipped. Two passes over the listing, counting then placing, with no sort.
+XrefIndex build_xrefs(const MemoryImage& memory, const std::vector<DisassembledInstruction>& disassembly, CpuType cpu);
+
+// "CALL", "JMP", "READ", "WRITE" or "LXI".
+const char* xref_kind_name(XrefKind kind);
+
+// Writes a cross-reference table: one line per address that is referred
+// to, with its label if it has one, then each reference as its kind letter
+// (C, J, R, W, A) and source address, eight to a line.
+void write_xref_listing(std::ostream& out, const XrefIndex& xrefs, const SymbolMap& symbols);
@@ -1,9 +1,61 @@
 #pragma once
 
+#include <algorithm>
 #include "CpuDisassembler.h"
+#include "OpcodeTable.h"
 
-class Disassembler8080 : public CpuDisassembler {
+// The decoder shared by the 8080 and its descendants. 'Cpu' names the
+// concrete class and supplies its table as a static 'opcodes' member, so
+// the range loop is compiled once per CPU with the table fixed and no
+// virtual calls inside it (CRTP).
+template <typename Cpu>
+class Intel8080Family : public CpuDisassembler {
     public:
         // Disassembes a single instruction at a given address in memory.
-        DisassembledInstruction disassemble_op(const MemoryMap& memory, uint32_t pc, const SymbolMap& symbols) override;
+        // Bytes that are not in the image read as 0.
+        DisassembledInstruction disassemble_op(const MemoryImage& memory, uint32_t pc) override {
+            uint8_t bytes[3] = {memory.read_or(pc, 0), memory.read_or(pc + 1, 0), memory.read_or(pc + 2, 0)};
+            return decode(bytes, pc);
+        }
+
+        using CpuDisassembler::disassemble_range;
+        size_t disassemble_range(ByteSpan bytes, uint32_t base_address,
+                                 std::vector<DisassembledInstruction>& out, size_t limit) override {
+            const uint8_t* data = bytes.data;
+            size_t size = bytes.size;
+            limit = std::min(limit, size);
+            size_t offset = 0;
+            // Both operand bytes are inside the span: no bounds checks needed.
+            size_t fast_end = size >= 2 ? std::min(limit, size - 2) : 0;
+            while (offset < fast_end) {
+                DisassembledInstruction instr = decode(data + offset, base_address + static_cast<uint32_t>(offset));
+                out.push_back(instr);
+                offset += instr.size;
+            }
+            // The last two bytes: pad the operand with zeros.
+            while (offset < limit) {
+                uint8_t tail[3] = {data[offset], 0, 0};
+                std::copy(data + offset + 1, data + std::min(size, offset + 3), tail + 1);
+                DisassembledInstruction instr = decode(tail, base_address + static_cast<uint32_t>(offset));
+                out.push_back(instr);
+                offset += instr.size;
+            }
+            return offset;
+        }
+
+    private:
+        // Decodes the instruction in bytes[0..2]; the bytes beyond its size are ignored.
+        static DisassembledInstruction decode(const uint8_t* bytes, uint32_t address) {
+            static constexpr uint32_t operand_mask[4] = {0, 0, 0x00FF, 0xFFFF};
+            const OpcodeInfo& info = Cpu::opcodes[bytes[0]];
+            uint32_t operand = (bytes[1] | (uint32_t(bytes[2]) << 8)) & operand_mask[info.size];
+            return {address, operand, bytes[0], info.size, 0, 0};
+        }
+};
+
+class Disassembler8080 : public Intel8080Family<Disassembler8080> {
+    public:
+        static constexpr const OpcodeTable& opcodes = opcodes_8080;
 };
+
+extern template class Intel8080Family<Disassembler8080>;
@@ -1,5 +1,5 @@
 /**********************************************************
- * This class inherits from the i8080, this is due to 
+ * This class shares the i8080 decoder, this is due to 
  * the 8085 is a subset of the 8080. 
  * Author: Andrew Young
  * Date: September 26, 2025
@@ -13,7 +13,11 @@
 
 #include "i8080.h"
 
-class Disassembler8085 : public Disassembler8080 {
+class Disassembler8085 : public Intel8080Family<Disassembler8085> {
     public:
-        DisassembledInstruction disassemble_op(const MemoryMap& memory, uint32_t pc, const SymbolMap& symbols) override;
+        static constexpr const OpcodeTable& opcodes = opcodes_8085;
+
+        DisassembledInstruction disassemble_op(const MemoryImage& memory, uint32_t pc) override;
 };
+
+extern template class Intel8080Family<Disassembler8085>;
@@ -0,0 +1,209 @@
+#include "BinaryWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Address-space bytes dealt into lanes per step; a multiple of every lane count.
+static constexpr size_t kLaneBlock = 1 << 20;
+static constexpr size_t kFillBlock = 64 * 1024;
+
+namespace {
+
+// Cuts each lane's stream into parts of split_size bytes. All lanes advance
+// together, so one position counter serves them all.
+class PartSplitter {
+    public:
+        PartSplitter(const BinaryLaneSink& sink, uint64_t split_size) : sink_(sink), split_size_(split_size) {}
+
+        // Emits 'size' bytes for every lane; lane i's bytes are at lanes[i].
+        bool emit(const std::vector<const uint8_t*>& lanes, size_t size) {
+            size_t done = 0;
+            while (done < size) {
+                uint64_t part = split_size_ ? position_ / split_size_ : 0;
+                size_t count = size - done;
+                if (split_size_) {
+                    count = static_cast<size_t>(std::min<uint64_t>(count, split_size_ - position_ % split_size_));
+                }
+                for (unsigned lane = 0; lane < lanes.size(); ++lane) {
+                    if (!sink_(lane, part, lanes[lane] + done, count)) {
+                        return false;
+                    }
+                }
+                done += count;
+                position_ += count;
+            }
+            return true;
+        }
+
+        // Bytes still missing from the last part.
+        uint64_t padding() const {
+            if (!split_size_ || position_ % split_size_ == 0) {
+                return 0;
+            }
+            return split_size_ - position_ % split_size_;
+        }
+
+    private:
+        const BinaryLaneSink& sink_;
+        uint64_t split_size_;
+        uint64_t position_ = 0;
+};
+
+} // namespace
+
+bool export_binary(const MemoryImage& memory, const BinaryExportOptions& options, const BinaryLaneSink& sink) {
+    unsigned lanes = options.interleave;
+    if (lanes != 1 && lanes != 2 && lanes != 4) {
+        return false;
+    }
+    if (memory.empty() && !(options.start && options.end)) {
+        return false;
+    }
+    uint64_t first = options.start.value_or(memory.min_address());
+    uint64_t last = options.end.value_or(memory.max_address());
+    if (first > last) {
+        return false;
+    }
+
+    std::vector<uint8_t> fill_block(kFillBlock, options.fill);
+    PartSplitter splitter(sink, options.split_size);
+
+    // Interleaved output is gathered a block of address space at a time and
+    // then dealt into the lanes; plain output passes the pieces straight on.
+    std::vector<uint8_t> block;
+    std::vector<std::vector<uint8_t>> lane_data;
+    size_t block_used = 0;
+    if (lanes > 1) {
+        block.resize(kLaneBlock);
+        lane_data.assign(lanes, std::vector<uint8_t>(kLaneBlock / lanes));
+    }
+    auto flush_block = [&]() {
+        // Pad a short final block so every lane gets the same number of bytes.
+        while (block_used % lanes) {
+            block[block_used++] = options.fill;
+        }
+        size_t per_lane = block_used / lanes;
+        std::vector<const uint8_t*> pointers(lanes);
+        for (unsigned lane = 0; lane < lanes; ++lane) {
+            uint8_t* out = lane_data[lane].data();
+            for (size_t i = 0; i < per_lane; ++i) {
+                out[i] = block[i * lanes + lane];
+            }
+            pointers[lane] = out;
+        }
+        block_used = 0;
+        return splitter.emit(pointers, per_lane);
+    };
+    auto emit = [&](const uint8_t* data, size_t size) {
+        if (lanes == 1) {
+            return splitter.emit({data}, size);
+        }
+        while (size > 0) {
+            size_t count = std::min(size, block.size() - block_used);
+            std::memcpy(block.data() + block_used, data, count);
+            block_used += count;
+            data += count;
+            size -= count;
+            if (block_used == block.size() && !flush_block()) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto emit_fill = [&](uint64_t count) {
+        while (count > 0) {
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(count, fill_block.size()));
+            if (!emit(fill_block.data(), chunk)) {
+                return false;
+            }
+            count -= chunk;
+        }
+        return true;
+    };
+
+    // Walk the range as alternating gaps and slices of the segments.
+    uint64_t position = first;
+    uint64_t stop = last + 1;
+    for (const MemorySegment& segment : memory.segments()) {
+        if (segment.end() <= position) {
+            continue;
+        }
+        if (segment.start >= stop) {
+            break;
+        }
+        uint64_t slice_start = std::max<uint64_t>(segment.start, position);
+        uint64_t slice_end = std::min<uint64_t>(segment.end(), stop);
+        if (!emit_fill(slice_start - position) ||
+            !emit(segment.data + (slice_start - segment.start), static_cast<size_t>(slice_end - slice_start))) {
+            return false;
+        }
+        position = slice_end;
+    }
+    if (!emit_fill(stop - position)) {
+        return false;
+    }
+    if (lanes > 1 && block_used > 0 && !flush_block()) {
+        return false;
+    }
+
+    // PROM images are full size: pad the last part of every lane.
+    for (uint64_t pad = splitter.padding(); pad > 0;) {
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(pad, fill_block.size()));
+        if (!splitter.emit(std::vector<const uint8_t*>(lanes, fill_block.data()), chunk)) {
+            return false;
+        }
+        pad -= chunk;
+    }
+    return true;
+}
+
+std::string binary_export_path(const std::string& file_path, const BinaryExportOptions& options, unsigned lane, uint64_t part) {
+    // Insert the suffix before the extension, if the file name has one.
+    size_t slash = file_path.find_last_of("/\\");
+    size_t dot = file_path.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        dot = file_path.size();
+    }
+    std::string suffix;
+    if (options.interleave == 2) {
+        suffix += lane == 0 ? "_even" : "_odd";
+    } else if (options.interleave > 2) {
+        suffix += "_b" + std::to_string(lane);
+    }
+    if (options.split_size) {
+        suffix += "_" + std::to_string(part);
+    }
+    return file_path.substr(0, dot) + suffix + file_path.substr(dot);
+}
+
+bool export_binary_file(const std::string& file_path, const MemoryImage& memory, const BinaryExportOptions& options,
+                        std::vector<std::string>* written) {
+    // One open file per lane; a lane moves on to its next file when the part changes.
+    std::vector<std::ofstream> files(std::max(1u, options.interleave));
+    std::vector<uint64_t> open_part(files.size(), UINT64_MAX);
+    bool ok = export_binary(memory, options, [&](unsigned lane, uint64_t part, const uint8_t* data, size_t size) {
+        if (open_part[lane] != part) {
+            files[lane].close();
+            std::string path = binary_export_path(file_path, options, lane, part);
+            files[lane].open(path, std::ios::binary | std::ios::trunc);
+            if (!files[lane].is_open()) {
+                std::cerr << "ERROR: Could not open " << path << " for writing." << std::endl;
+                return false;
+            }
+            open_part[lane] = part;
+            if (written) {
+                written->push_back(path);
+            }
+        }
+        files[lane].write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        return static_cast<bool>(files[lane]);
+    });
+    for (auto& file : files) {
+        if (file.is_open()) {
+            file.close();
+            ok = ok && !file.fail();
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,139 @@
+#include "CodeFlow.h"
+#include <algorithm>
+
+const CodeMap::Bits* CodeMap::find(uint32_t address) const {
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), address,
+                               [](uint32_t a, const Bits& bits) { return a < bits.start; });
+    if (it == segments_.begin()) {
+        return nullptr;
+    }
+    --it;
+    return address - it->start < it->length ? &*it : nullptr;
+}
+
+std::vector<uint32_t> collect_entry_points(const MemoryImage& memory, CpuType cpu, const CodeFlowOptions& options,
+                                           std::optional<uint32_t> start_address) {
+    std::vector<uint32_t> candidates = {0x0000};
+    if (options.interrupt_vectors) {
+        for (uint32_t vector = 0x08; vector <= 0x38; vector += 8) {
+            candidates.push_back(vector);
+        }
+        if (cpu == CpuType::I8085) {
+            // TRAP, RST 5.5, RST 6.5 and RST 7.5.
+            candidates.insert(candidates.end(), {0x24, 0x2C, 0x34, 0x3C});
+        }
+    }
+    if (start_address) {
+        candidates.push_back(*start_address);
+    }
+    candidates.insert(candidates.end(), options.entry_points.begin(), options.entry_points.end());
+
+    std::vector<uint32_t> entry_points;
+    for (uint32_t address : candidates) {
+        if (memory.contains(address) && std::find(entry_points.begin(), entry_points.end(), address) == entry_points.end()) {
+            entry_points.push_back(address);
+        }
+    }
+    if (entry_points.empty() && !memory.empty()) {
+        entry_points.push_back(memory.min_address());
+    }
+    return entry_points;
+}
+
+CodeMap analyze_code_flow(const MemoryImage& memory, CpuType cpu, const std::vector<uint32_t>& entry_points) {
+    const OpcodeTable& opcodes = opcode_table(cpu);
+    std::vector<MemorySegment> segments = memory.segments();
+    CodeMap map;
+    map.segments_.reserve(segments.size());
+    for (const MemorySegment& segment : segments) {
+        map.segments_.push_back({segment.start, segment.length, {}, {}});
+    }
+
+    // Addresses still to follow. Popped from the back, so the first entry
+    // point is traced first and wins where paths disagree.
+    std::vector<uint32_t> worklist(entry_points.rbegin(), entry_points.rend());
+    while (!worklist.empty()) {
+        uint64_t pc = worklist.back();
+        worklist.pop_back();
+
+        size_t s = segments.size();
+        while (pc <= 0xFFFFFFFF) {
+            // Stay in the current segment while falling through; look it up
+            // again only when the path leaves it.
+            if (s == segments.size() || pc < segments[s].start || pc >= segments[s].end()) {
+                const CodeMap::Bits* bits = map.find(static_cast<uint32_t>(pc));
+                if (!bits) {
+                    break; // Not in the image
+                }
+                s = bits - map.segments_.data();
+            }
+            const MemorySegment& segment = segments[s];
+            CodeMap::Bits& bits = map.segments_[s];
+            size_t offset = size_t(pc - segment.start);
+            if (CodeMap::get(bits.starts, offset)) {
+                break; // Already traced from here
+            }
+
+            uint8_t opcode = segment.data[offset];
+            const OpcodeInfo& info = opcodes[opcode];
+            if (info.mnemonic == Mnemonic::Unknown || offset + info.size > segment.length) {
+                break; // Not an instruction, or its operand is missing
+            }
+            bool overlaps = false;
+            for (size_t i = 0; i < info.size; ++i) {
+                overlaps |= CodeMap::get(bits.code, offset + i);
+            }
+            if (overlaps) {
+                break; // Would run across an instruction found earlier
+            }
+
+            if (bits.starts.empty()) {
+                bits.starts.assign((segment.length + 63) / 64, 0);
+                bits.code.assign((segment.length + 63) / 64, 0);
+            }
+            CodeMap::set(bits.starts, offset);
+            for (size_t i = 0; i < info.size; ++i) {
+                CodeMap::set(bits.code, offset + i);
+            }
+            ++map.instruction_count_;
+            map.code_bytes_ += info.size;
+
+            uint32_t target = 0;
+            if (info.has_code_target()) {
+                target = segment.data[offset + 1] | (uint32_t(segment.data[offset + 2]) << 8);
+                map.targets_.push_back(target);
+            }
+            bool falls_through = true;
+            switch (info.flow) {
+                case FlowType::Sequential:
+                case FlowType::CondReturn:
+                    break;
+                case FlowType::Jump:
+                    worklist.push_back(target);
+                    falls_through = false;
+                    break;
+                case FlowType::CondJump:
+                case FlowType::Call:
+                case FlowType::CondCall:
+                    worklist.push_back(target);
+                    break;
+                case FlowType::Restart:
+                    worklist.push_back(opcode & 0x38);
+                    break;
+                case FlowType::Return:
+                case FlowType::IndirectJump:
+                case FlowType::Halt:
+                    falls_through = false;
+                    break;
+            }
+            if (!falls_through) {
+                break;
+            }
+            pc += info.size;
+        }
+    }
+
+    std::sort(map.targets_.begin(), map.targets_.end());
+    map.targets_.erase(std::unique(map.targets_.begin(), map.targets_.end()), map.targets_.end());
+    return map;
+}
@@ -0,0 +1,466 @@
+#include "Disassembly.h"
+#include "i8080.h"
+#include "i8085.h"
+#include "HexDecode.h"
+#include "FillScan.h"
+#include "ThreadPool.h"
+#include "CodeFlow.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <optional>
+
+std::unique_ptr<CpuDisassembler> make_disassembler(CpuType cpu) {
+    if (cpu == CpuType::I8085) {
+        return std::make_unique<Disassembler8085>();
+    }
+    return std::make_unique<Disassembler8080>();
+}
+
+const OpcodeTable& opcode_table(CpuType cpu) {
+    return cpu == CpuType::I8085 ? opcodes_8085 : opcodes_8080;
+}
+
+// How many bytes of code are decoded between progress reports.
+static constexpr size_t kProgressChunk = 64 * 1024;
+
+// Below this much code per window the threading overhead outweighs the gain.
+static constexpr size_t kMinParallelWindow = 256 * 1024;
+
+// Runs of at least 4 0x00 or 0xFF bytes in a segment, in address order.
+// These are the candidates for folding into DB lines.
+static std::vector<FillRun> find_data_runs(ByteSpan bytes) {
+    std::vector<FillRun> zeros = find_fill_runs(bytes, 0x00, 4);
+    std::vector<FillRun> ones = find_fill_runs(bytes, 0xFF, 4);
+    std::vector<FillRun> runs(zeros.size() + ones.size());
+    std::merge(zeros.begin(), zeros.end(), ones.begin(), ones.end(), runs.begin(),
+               [](const FillRun& a, const FillRun& b) { return a.offset < b.offset; });
+    return runs;
+}
+
+namespace {
+
+// A segment together with its data runs.
+struct CodeSegment {
+    MemorySegment segment;
+    std::vector<FillRun> runs;
+};
+
+} // namespace
+
+// The linear sweep over one segment: decodes from 'pc' until it reaches
+// 'stop' bytes into the segment, appending to 'out', and returns the next
+// address to decode. 'pc' must lie inside the segment. The next address
+// depends on nothing but the current one, which is what lets the parallel
+// sweep resynchronise. 'progress' is checked between chunks; when it
+// returns false the sweep stops and returns std::nullopt.
+static std::optional<uint64_t> sweep_segment(const MemoryImage& memory, CpuDisassembler& disassembler,
+                                             const CodeSegment& code, uint64_t pc, size_t stop,
+                                             std::vector<DisassembledInstruction>& out,
+                                             const std::function<bool(uint64_t)>& progress = nullptr) {
+    const MemorySegment& segment = code.segment;
+    const std::vector<FillRun>& runs = code.runs;
+    const uint8_t* data = segment.data;
+    size_t length = segment.length;
+    size_t offset = size_t(pc - segment.start);
+    stop = std::min(stop, length);
+
+    // Heuristic for data blocks: wherever an instruction would start on
+    // 4 or more remaining bytes of a 0x00/0xFF run, the rest of the run
+    // becomes one DB line. Code in between is decoded a range at a time.
+    size_t range_end = length > 2 ? length - 2 : 0;
+    size_t next_run = std::lower_bound(runs.begin(), runs.end(), offset + 4, [](const FillRun& run, size_t end) {
+                          return run.offset + run.length < end;
+                      }) - runs.begin();
+    while (offset < stop) {
+        while (next_run < runs.size() && runs[next_run].offset + runs[next_run].length < offset + 4) {
+            ++next_run;
+        }
+        if (next_run < runs.size() && offset >= runs[next_run].offset) {
+            size_t count = runs[next_run].offset + runs[next_run].length - offset;
+            out.push_back({segment.start + static_cast<uint32_t>(offset), static_cast<uint32_t>(count),
+                           data[offset], static_cast<uint8_t>(std::min<size_t>(count, 0xFF)),
+                           kInstructionDataRun, 0});
+            offset += count;
+            continue;
+        }
+
+        if (offset < range_end && progress && !progress(segment.start + offset)) {
+            return std::nullopt;
+        }
+        if (offset >= range_end) {
+            // Operands may run past the segment into a later one, so the
+            // last two bytes go through the image.
+            DisassembledInstruction instr =
+                disassembler.disassemble_op(memory, segment.start + static_cast<uint32_t>(offset));
+            out.push_back(instr);
+            offset += instr.size;
+            continue;
+        }
+        size_t limit = next_run < runs.size() ? runs[next_run].offset : length;
+        limit = std::min({limit, range_end, stop, offset + kProgressChunk});
+        offset += disassembler.disassemble_range({data + offset, length - offset},
+                                                 segment.start + static_cast<uint32_t>(offset), out, limit - offset);
+    }
+    return segment.start + offset;
+}
+
+std::vector<DisassembledInstruction> disassemble_image(const MemoryImage& memory, CpuDisassembler& disassembler,
+                                                       const ProgressCallback& progress) {
+    std::vector<DisassembledInstruction> disassembly;
+    if (memory.empty()) {
+        return disassembly;
+    }
+
+    const uint32_t min_addr = memory.min_address();
+    const double span = double(memory.max_address() - min_addr) + 1;
+    std::function<bool(uint64_t)> report;
+    if (progress) {
+        report = [&](uint64_t pc) { return progress(float((pc - min_addr) / span)); };
+    }
+
+    // The next address to decode. An instruction at the end of a segment may
+    // carry it past the start of the next one.
+    uint64_t pc = min_addr;
+    for (const MemorySegment& segment : memory.segments()) {
+        if (pc >= segment.end()) {
+            continue;
+        }
+        CodeSegment code{segment, find_data_runs(segment.bytes())};
+        std::optional<uint64_t> next =
+            sweep_segment(memory, disassembler, code, std::max<uint64_t>(pc, segment.start), segment.length,
+                          disassembly, report);
+        if (!next) {
+            break;
+        }
+        pc = *next;
+    }
+    return disassembly;
+}
+
+namespace {
+
+// A slice of one segment, [begin, end) bytes into it.
+struct CodePiece {
+    size_t segment;
+    size_t begin;
+    size_t end;
+};
+
+// One parallel job: consecutive pieces decoded back to back, as if the
+// sweep had reached the first of them exactly at its start.
+struct SweepWindow {
+    size_t first_piece;
+    size_t last_piece; // One past the last
+    std::vector<DisassembledInstruction> out;
+    uint64_t exit_pc = 0; // The address the sweep continues at after this window
+    bool done = false;
+};
+
+} // namespace
+
+// Sweeps pieces [first, last) starting at 'pc', appending to 'out', and
+// returns the next address. With 'until' set the sweep stops as soon as it
+// reaches an address for which until(pc) is true.
+static uint64_t sweep_pieces(const MemoryImage& memory, CpuDisassembler& disassembler,
+                             const std::vector<CodeSegment>& segments, const std::vector<CodePiece>& pieces,
+                             size_t first, size_t last, uint64_t pc, std::vector<DisassembledInstruction>& out,
+                             const std::function<bool(uint64_t)>& until = nullptr) {
+    for (size_t p = first; p < last; ++p) {
+        const CodeSegment& code = segments[pieces[p].segment];
+        uint64_t piece_start = code.segment.start + pieces[p].begin;
+        uint64_t piece_end = code.segment.start + pieces[p].end;
+        if (pc >= piece_end) {
+            continue;
+        }
+        pc = std::max(pc, piece_start);
+        if (!until) {
+            pc = *sweep_segment(memory, disassembler, code, pc, pieces[p].end, out);
+            continue;
+        }
+        // One instruction or DB line at a time, checking after each.
+        while (pc < piece_end) {
+            if (until(pc)) {
+                return pc;
+            }
+            pc = *sweep_segment(memory, disassembler, code, pc, size_t(pc - code.segment.start) + 1, out);
+        }
+    }
+    return pc;
+}
+
+std::vector<DisassembledInstruction> disassemble_image_parallel(const MemoryImage& memory,
+                                                                CpuDisassembler& disassembler,
+                                                                const ProgressCallback& progress,
+                                                                unsigned thread_count) {
+    size_t total = memory.size();
+    size_t window_count = std::min<size_t>(static_cast<size_t>(resolve_thread_count(thread_count)) * 4,
+                                           total / kMinParallelWindow);
+    if (window_count <= 1) {
+        return disassemble_image(memory, disassembler, progress);
+    }
+
+    // Cut the segments into pieces of at most one window, then deal runs of
+    // consecutive pieces out as windows of about that size. Small segments
+    // share a window; big ones are split over several.
+    std::vector<MemorySegment> image_segments = memory.segments();
+    std::vector<CodeSegment> segments(image_segments.size());
+    ThreadPool::shared().parallel_for(segments.size(), [&](size_t i) {
+        segments[i] = {image_segments[i], find_data_runs(image_segments[i].bytes())};
+    });
+
+    size_t window_bytes = (total + window_count - 1) / window_count;
+    std::vector<CodePiece> pieces;
+    std::vector<SweepWindow> windows;
+    size_t filled = window_bytes;
+    for (size_t s = 0; s < segments.size(); ++s) {
+        size_t length = segments[s].segment.length;
+        for (size_t begin = 0; begin < length;) {
+            if (filled >= window_bytes) {
+                windows.push_back({pieces.size(), pieces.size(), {}, 0, false});
+                filled = 0;
+            }
+            size_t end = begin + std::min(length - begin, window_bytes - filled);
+            pieces.push_back({s, begin, end});
+            windows.back().last_piece = pieces.size();
+            filled += end - begin;
+            begin = end;
+        }
+    }
+
+    // Decode every window speculatively, as if the sweep entered it at its
+    // first byte.
+    std::atomic<bool> cancelled{false};
+    std::mutex progress_mutex;
+    size_t finished = 0;
+    ThreadPool::shared().parallel_for(windows.size(), [&](size_t w) {
+        if (cancelled.load()) {
+            return;
+        }
+        SweepWindow& window = windows[w];
+        const CodePiece& first = pieces[window.first_piece];
+        uint64_t start = segments[first.segment].segment.start + first.begin;
+        window.exit_pc = sweep_pieces(memory, disassembler, segments, pieces, window.first_piece, window.last_piece,
+                                      start, window.out);
+        window.done = true;
+        if (progress) {
+            std::lock_guard<std::mutex> lock(progress_mutex);
+            if (!progress(float(++finished) / windows.size())) {
+                cancelled = true;
+            }
+        }
+    });
+
+    // Stitch the windows in address order. Where the real sweep enters a
+    // window past its first byte, decode from there until it lands on an
+    // address the speculative decode also started at; from that point on the
+    // two agree, so the rest of the window is reused as is.
+    std::vector<DisassembledInstruction> disassembly;
+    size_t count = 0;
+    for (const SweepWindow& window : windows) {
+        count += window.out.size();
+    }
+    disassembly.reserve(count);
+    uint64_t pc = memory.min_address();
+    for (SweepWindow& window : windows) {
+        if (!window.done) {
+            break; // Cancelled
+        }
+        const CodePiece& first = pieces[window.first_piece];
+        uint64_t start = segments[first.segment].segment.start + first.begin;
+        auto resume = window.out.begin();
+        if (pc > start) {
+            bool synced = false;
+            auto starts_here = [&](uint64_t address) {
+                resume = std::lower_bound(window.out.begin(), window.out.end(), address,
+                                          [](const DisassembledInstruction& instr, uint64_t a) {
+                                              return instr.address < a;
+                                          });
+                synced = resume != window.out.end() && resume->address == address;
+                return synced;
+            };
+            pc = sweep_pieces(memory, disassembler, segments, pieces, window.first_piece, window.last_piece, pc,
+                              disassembly, starts_here);
+            if (!synced) {
+                continue; // The sweep ran past the window without meeting it.
+            }
+        }
+        disassembly.insert(disassembly.end(), resume, window.out.end());
+        pc = window.exit_pc;
+        std::vector<DisassembledInstruction>().swap(window.out);
+    }
+    return disassembly;
+}
+
+std::vector<DisassembledInstruction> disassemble_code_map(const MemoryImage& memory, CpuDisassembler& disassembler,
+                                                          const CodeMap& code) {
+    std::vector<DisassembledInstruction> disassembly;
+    const std::vector<uint32_t>& labels = code.targets();
+    std::vector<MemorySegment> segments = memory.segments();
+    for (size_t s = 0; s < segments.size(); ++s) {
+        const MemorySegment& segment = segments[s];
+        const CodeMap::Bits& bits = code.segments_[s];
+        const uint8_t* data = segment.data;
+        size_t length = segment.length;
+        std::vector<FillRun> runs = find_data_runs(segment.bytes());
+        size_t next_run = 0;
+        auto next_label = std::upper_bound(labels.begin(), labels.end(), segment.start);
+
+        size_t offset = 0;
+        while (offset < length) {
+            // Code blocks always begin with an instruction and hold whole
+            // instructions back to back, so they decode as one range.
+            size_t end = offset;
+            bool is_code = CodeMap::get(bits.code, offset);
+            while (end < length && CodeMap::get(bits.code, end) == is_code) {
+                ++end;
+            }
+            if (is_code) {
+                offset += disassembler.disassemble_range({data + offset, length - offset},
+                                                         segment.start + static_cast<uint32_t>(offset), disassembly,
+                                                         end - offset);
+                continue;
+            }
+
+            while (offset < end) {
+                uint32_t address = segment.start + static_cast<uint32_t>(offset);
+                while (next_label != labels.end() && *next_label <= address) {
+                    ++next_label;
+                }
+                size_t stop = end;
+                if (next_label != labels.end() && *next_label - segment.start < end) {
+                    stop = *next_label - segment.start;
+                }
+                while (next_run < runs.size() && runs[next_run].offset + runs[next_run].length < offset + 4) {
+                    ++next_run;
+                }
+                size_t run_start = next_run < runs.size() ? runs[next_run].offset : length;
+                if (offset >= run_start) {
+                    size_t count = std::min(runs[next_run].offset + runs[next_run].length, stop) - offset;
+                    if (count >= 4) {
+                        disassembly.push_back({address, static_cast<uint32_t>(count), data[offset],
+                                               static_cast<uint8_t>(std::min<size_t>(count, 0xFF)),
+                                               kInstructionDataRun, 0});
+                        offset += count;
+                        continue;
+                    }
+                } else {
+                    stop = std::min(stop, run_start);
+                }
+                // Up to 4 plain bytes: the first in 'opcode', the rest in 'operand'.
+                size_t count = std::min<size_t>(stop - offset, 4);
+                uint32_t rest = 0;
+                for (size_t i = 1; i < count; ++i) {
+                    rest |= uint32_t(data[offset + i]) << (8 * (i - 1));
+                }
+                disassembly.push_back({address, rest, data[offset], static_cast<uint8_t>(count), kInstructionData, 0});
+                offset += count;
+            }
+        }
+    }
+    return disassembly;
+}
+
+// Copies 'length' characters to 'first', stopping at 'last'.
+static char* put(char* first, char* last, const char* text, size_t length) {
+    length = std::min<size_t>(length, last - first);
+    std::memcpy(first, text, length);
+    return first + length;
+}
+
+// Writes 'prefix' followed by 'digits' upper-case hex digits of 'value'.
+static char* put_hex(char* first, char* last, const char* prefix, uint32_t value, int digits) {
+    char text[8];
+    size_t length = std::strlen(prefix);
+    std::memcpy(text, prefix, length);
+    if (digits == 4) {
+        encode_hex_pair(static_cast<uint8_t>(value >> 8), text + length);
+        length += 2;
+    }
+    encode_hex_pair(static_cast<uint8_t>(value), text + length);
+    return put(first, last, text, length + 2);
+}
+
+// Writes a byte the way DB lines show it: "0" + the byte without leading
+// zeros + "h", e.g. "00h", "03Eh", "0FFh". Needs room for 4 characters.
+static char* put_db_byte(char* first, uint8_t value) {
+    *first++ = '0';
+    char* end = std::to_chars(first, first + 2, value, 16).ptr;
+    std::transform(first, end, first, [](char c) { return static_cast<char>(std::toupper(c)); });
+    *end = 'h';
+    return end + 1;
+}
+
+char* format_instruction(char* first, char* last, const DisassembledInstruction& instr,
+                         const OpcodeTable& opcodes, const SymbolMap& symbols) {
+    if (instr.flags & kInstructionMissing) {
+        return put(first, last, "???", 3);
+    }
+    if (instr.flags & kInstructionDataRun) {
+        // "DB   0FFh (N bytes)"
+        char text[48] = "DB   ";
+        char* end = put_db_byte(text + 5, instr.opcode);
+        std::memcpy(end, " (", 2);
+        end = std::to_chars(end + 2, text + sizeof(text), instr.operand).ptr;
+        std::memcpy(end, " bytes)", 7);
+        return put(first, last, text, end + 7 - text);
+    }
+    if (instr.flags & kInstructionData) {
+        // "DB   03Eh, 01h, 0C3h"
+        char text[32] = "DB   ";
+        char* end = put_db_byte(text + 5, instr.opcode);
+        for (int i = 1; i < instr.size; ++i) {
+            std::memcpy(end, ", ", 2);
+            end = put_db_byte(end + 2, static_cast<uint8_t>(instr.operand >> (8 * (i - 1))));
+        }
+        return put(first, last, text, end - text);
+    }
+
+    const OpcodeInfo& info = opcodes[instr.opcode];
+    first = put(first, last, info.text, info.text_length);
+    switch (info.operand) {
+        case OperandKind::None:
+            break;
+        case OperandKind::Imm8:
+            first = put_hex(first, last, "#$", instr.operand, 2);
+            break;
+        case OperandKind::Imm16:
+            first = put_hex(first, last, "#$", instr.operand, 4);
+            break;
+        case OperandKind::Addr16:
+            first = put_hex(first, last, "$", instr.operand, 4);
+            break;
+        case OperandKind::Target16: {
+            if (const SymbolMap::Symbol* symbol = symbols.find(instr.operand)) {
+                first = symbols.format_name(first, last, *symbol);
+            } else {
+                first = put_hex(first, last, "$", instr.operand, 4);
+            }
+            break;
+        }
+    }
+    return first;
+}
+
+void write_disassembly_listing(std::ostream& out, const std::vector<DisassembledInstruction>& disassembly,
+                               CpuType cpu, const SymbolMap& symbols) {
+    const OpcodeTable& opcodes = opcode_table(cpu);
+    char line[256];
+    for (const auto& instr : disassembly) {
+        if (const SymbolMap::Symbol* symbol = symbols.find(instr.address)) {
+            line[0] = '\n';
+            char* end = symbols.format_name(line + 1, line + sizeof(line) - 2, *symbol);
+            *end++ = ':';
+            *end++ = '\n';
+            out.write(line, end - line);
+        }
+        int prefix = std::snprintf(line, sizeof(line), "  0x%04X:  ", instr.address);
+        char* end = format_instruction(line + prefix, line + sizeof(line) - 1, instr, opcodes, symbols);
+        *end++ = '\n';
+        out.write(line, end - line);
+    }
+}
@@ -0,0 +1,133 @@
+#include "FillScan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FILL_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+// Every kernel answers the same question: the first offset in [from, size)
+// whose byte is (want_fill ? equal : not equal) to 'fill', or 'size'.
+using FindFn = size_t (*)(const uint8_t*, size_t, size_t, uint8_t, bool);
+// One past the last byte in [0, size) that differs from 'fill', or 0.
+using LastEndFn = size_t (*)(const uint8_t*, size_t, uint8_t);
+
+static size_t find_scalar(const uint8_t* data, size_t size, size_t from, uint8_t fill, bool want_fill) {
+    for (size_t i = from; i < size; ++i) {
+        if ((data[i] == fill) == want_fill) {
+            return i;
+        }
+    }
+    return size;
+}
+
+static size_t last_not_fill_end_scalar(const uint8_t* data, size_t size, uint8_t fill) {
+    while (size > 0 && data[size - 1] == fill) {
+        --size;
+    }
+    return size;
+}
+
+#ifdef FILL_SCAN_X86
+
+__attribute__((target("sse2")))
+static size_t find_sse2(const uint8_t* data, size_t size, size_t from, uint8_t fill, bool want_fill) {
+    const __m128i pattern = _mm_set1_epi8(static_cast<char>(fill));
+    // Mask bits are set where a byte equals the fill; flip them when hunting for data.
+    const uint32_t flip = want_fill ? 0 : 0xFFFF;
+    size_t i = from;
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, pattern))) ^ flip;
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return find_scalar(data, size, i, fill, want_fill);
+}
+
+__attribute__((target("avx2")))
+static size_t find_avx2(const uint8_t* data, size_t size, size_t from, uint8_t fill, bool want_fill) {
+    const __m256i pattern = _mm256_set1_epi8(static_cast<char>(fill));
+    const uint32_t flip = want_fill ? 0 : 0xFFFFFFFF;
+    size_t i = from;
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, pattern))) ^ flip;
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return find_sse2(data, size, i, fill, want_fill);
+}
+
+// Backwards search for the last non-fill byte, 16 bytes at a time.
+__attribute__((target("sse2")))
+static size_t last_not_fill_end_sse2(const uint8_t* data, size_t size, uint8_t fill) {
+    const __m128i pattern = _mm_set1_epi8(static_cast<char>(fill));
+    size_t end = size;
+    while (end >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + end - 16));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, pattern))) ^ 0xFFFF;
+        if (mask) {
+            return end - 16 + (31 - __builtin_clz(mask)) + 1;
+        }
+        end -= 16;
+    }
+    return last_not_fill_end_scalar(data, end, fill);
+}
+
+#endif // FILL_SCAN_X86
+
+struct FillScanner {
+    FindFn find;
+    LastEndFn last_end;
+    const char* name;
+};
+
+static FillScanner select_fill_scanner() {
+#ifdef FILL_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {find_avx2, last_not_fill_end_sse2, "AVX2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {find_sse2, last_not_fill_end_sse2, "SSE2"};
+    }
+#endif
+    return {find_scalar, last_not_fill_end_scalar, "scalar"};
+}
+
+static const FillScanner& active_fill_scanner() {
+    static const FillScanner scanner = select_fill_scanner();
+    return scanner;
+}
+
+size_t find_first_not_fill(ByteSpan bytes, uint8_t fill) {
+    return active_fill_scanner().find(bytes.data, bytes.size, 0, fill, false);
+}
+
+size_t find_last_not_fill_end(ByteSpan bytes, uint8_t fill) {
+    return active_fill_scanner().last_end(bytes.data, bytes.size, fill);
+}
+
+std::vector<FillRun> find_fill_runs(ByteSpan bytes, uint8_t fill, size_t min_length) {
+    FindFn find = active_fill_scanner().find;
+    std::vector<FillRun> runs;
+    size_t pos = 0;
+    while (pos < bytes.size) {
+        size_t run_start = find(bytes.data, bytes.size, pos, fill, true);
+        if (run_start == bytes.size) {
+            break;
+        }
+        size_t run_end = find(bytes.data, bytes.size, run_start, fill, false);
+        if (run_end - run_start >= min_length) {
+            runs.push_back({run_start, run_end - run_start});
+        }
+        pos = run_end;
+    }
+    return runs;
+}
+
+const char* fill_scan_kernel_name() {
+    return active_fill_scanner().name;
+}
@@ -0,0 +1,201 @@
+#include "HexDecode.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HEX_DECODE_X86 1
+#include <immintrin.h>
+#endif
+
+bool decode_hex_bytes_scalar(const char* src, size_t count, uint8_t* dst, uint8_t& sum) {
+    uint8_t bad = 0;
+    uint8_t local_sum = sum;
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t byte = decode_hex_pair(src + i * 2, bad);
+        dst[i] = byte;
+        local_sum += byte;
+    }
+    sum = local_sum;
+    return (bad & 0xF0) == 0;
+}
+
+void encode_hex_bytes_scalar(const uint8_t* src, size_t count, char* dst, uint8_t& sum) {
+    uint8_t local_sum = sum;
+    for (size_t i = 0; i < count; ++i) {
+        encode_hex_pair(src[i], dst + i * 2);
+        local_sum += src[i];
+    }
+    sum = local_sum;
+}
+
+#ifdef HEX_DECODE_X86
+
+// Turns 16 ASCII characters into 16 nibble values, clearing 'valid' lanes
+// for anything that is not 0-9, A-F or a-f. Signed compares are fine here:
+// characters >= 0x80 are negative and fail both range checks.
+__attribute__((target("sse2")))
+static inline __m128i ascii_to_nibbles_sse2(__m128i c, __m128i& valid) {
+    const __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    const __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                                           _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    const __m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                           _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    valid = _mm_or_si128(is_digit, is_alpha);
+    const __m128i digit_value = _mm_and_si128(is_digit, _mm_sub_epi8(c, _mm_set1_epi8('0')));
+    const __m128i alpha_value = _mm_and_si128(is_alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)));
+    return _mm_or_si128(digit_value, alpha_value);
+}
+
+// Folds pairs of nibbles (high first, as they appear in the text) into bytes,
+// leaving each result in the low half of a 16-bit lane.
+__attribute__((target("sse2")))
+static inline __m128i pack_nibble_pairs_sse2(__m128i n) {
+    return _mm_or_si128(_mm_and_si128(_mm_slli_epi16(n, 4), _mm_set1_epi16(0x00F0)),
+                        _mm_srli_epi16(n, 8));
+}
+
+// 32 characters -> 16 bytes per iteration.
+__attribute__((target("sse2")))
+static bool decode_hex_bytes_sse2(const char* src, size_t count, uint8_t* dst, uint8_t& sum) {
+    __m128i all_valid = _mm_set1_epi8(-1);
+    __m128i sums = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i valid0, valid1;
+        __m128i n0 = ascii_to_nibbles_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2)), valid0);
+        __m128i n1 = ascii_to_nibbles_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2 + 16)), valid1);
+        all_valid = _mm_and_si128(all_valid, _mm_and_si128(valid0, valid1));
+
+        __m128i bytes = _mm_packus_epi16(pack_nibble_pairs_sse2(n0), pack_nibble_pairs_sse2(n1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), bytes);
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(bytes, _mm_setzero_si128()));
+    }
+    if (_mm_movemask_epi8(all_valid) != 0xFFFF) {
+        return false;
+    }
+    sum += static_cast<uint8_t>(_mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+    return decode_hex_bytes_scalar(src + i * 2, count - i, dst + i, sum);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i ascii_to_nibbles_avx2(__m256i c, __m256i& valid) {
+    const __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+    const __m256i is_digit = _mm256_andnot_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('9')),
+                                                 _mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)));
+    const __m256i is_alpha = _mm256_andnot_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('f')),
+                                                 _mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)));
+    valid = _mm256_or_si256(is_digit, is_alpha);
+    const __m256i digit_value = _mm256_and_si256(is_digit, _mm256_sub_epi8(c, _mm256_set1_epi8('0')));
+    const __m256i alpha_value = _mm256_and_si256(is_alpha, _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10)));
+    return _mm256_or_si256(digit_value, alpha_value);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i pack_nibble_pairs_avx2(__m256i n) {
+    return _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(n, 4), _mm256_set1_epi16(0x00F0)),
+                           _mm256_srli_epi16(n, 8));
+}
+
+// 64 characters -> 32 bytes per iteration.
+__attribute__((target("avx2")))
+static bool decode_hex_bytes_avx2(const char* src, size_t count, uint8_t* dst, uint8_t& sum) {
+    __m256i all_valid = _mm256_set1_epi8(-1);
+    __m256i sums = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i valid0, valid1;
+        __m256i n0 = ascii_to_nibbles_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2)), valid0);
+        __m256i n1 = ascii_to_nibbles_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2 + 32)), valid1);
+        all_valid = _mm256_and_si256(all_valid, _mm256_and_si256(valid0, valid1));
+
+        // packus works per 128-bit lane, so put the quadwords back in order afterwards.
+        __m256i bytes = _mm256_packus_epi16(pack_nibble_pairs_avx2(n0), pack_nibble_pairs_avx2(n1));
+        bytes = _mm256_permute4x64_epi64(bytes, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), bytes);
+        sums = _mm256_add_epi64(sums, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+    if (_mm256_movemask_epi8(all_valid) != -1) {
+        return false;
+    }
+    __m128i folded = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    sum += static_cast<uint8_t>(_mm_cvtsi128_si32(folded) + _mm_cvtsi128_si32(_mm_srli_si128(folded, 8)));
+    // Up to 31 bytes remain; let the SSE2 kernel take another 16 before going scalar.
+    return decode_hex_bytes_sse2(src + i * 2, count - i, dst + i, sum);
+}
+
+// Turns 16 nibble values into their upper-case ASCII digits:
+// '0' + n, plus 7 more for 10..15 to land on 'A'..'F'.
+__attribute__((target("sse2")))
+static inline __m128i nibbles_to_ascii_sse2(__m128i n) {
+    const __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(n, _mm_set1_epi8(9)), _mm_set1_epi8(7));
+    return _mm_add_epi8(_mm_add_epi8(n, _mm_set1_epi8('0')), letter);
+}
+
+// 16 bytes -> 32 characters per iteration.
+__attribute__((target("sse2")))
+static void encode_hex_bytes_sse2(const uint8_t* src, size_t count, char* dst, uint8_t& sum) {
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+    __m128i sums = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), low_nibble);
+        __m128i lo = _mm_and_si128(bytes, low_nibble);
+        // Interleave so each byte's high digit comes first, as in the text.
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), nibbles_to_ascii_sse2(_mm_unpacklo_epi8(hi, lo)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2 + 16), nibbles_to_ascii_sse2(_mm_unpackhi_epi8(hi, lo)));
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(bytes, _mm_setzero_si128()));
+    }
+    sum += static_cast<uint8_t>(_mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+    encode_hex_bytes_scalar(src + i, count - i, dst + i * 2, sum);
+}
+
+#endif // HEX_DECODE_X86
+
+using DecodeHexFn = bool (*)(const char*, size_t, uint8_t*, uint8_t&);
+
+struct HexDecoder {
+    DecodeHexFn fn;
+    const char* name;
+};
+
+static HexDecoder select_hex_decoder() {
+#ifdef HEX_DECODE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {decode_hex_bytes_avx2, "AVX2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {decode_hex_bytes_sse2, "SSE2"};
+    }
+#endif
+    return {decode_hex_bytes_scalar, "scalar"};
+}
+
+static const HexDecoder& active_hex_decoder() {
+    static const HexDecoder decoder = select_hex_decoder();
+    return decoder;
+}
+
+bool decode_hex_bytes(const char* src, size_t count, uint8_t* dst, uint8_t& sum) {
+    return active_hex_decoder().fn(src, count, dst, sum);
+}
+
+const char* hex_decoder_name() {
+    return active_hex_decoder().name;
+}
+
+using EncodeHexFn = void (*)(const uint8_t*, size_t, char*, uint8_t&);
+
+static EncodeHexFn select_hex_encoder() {
+#ifdef HEX_DECODE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        return encode_hex_bytes_sse2;
+    }
+#endif
+    return encode_hex_bytes_scalar;
+}
+
+void encode_hex_bytes(const uint8_t* src, size_t count, char* dst, uint8_t& sum) {
+    static const EncodeHexFn encode = select_hex_encoder();
+    encode(src, count, dst, sum);
+}
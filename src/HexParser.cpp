@@ -1,126 +1,410 @@
 #include "HexParser.h" // Our header file
+#include "MappedFile.h"
+#include "HexDecode.h"
+#include "FillScan.h"
+#include "ThreadPool.h"
 #include <fstream>
-#include <numeric>
 #include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <mutex>
 
-// Implementation of the single-line parser.
-std::optional<HexRecord> parse_hex_record(const std::string& line) {
-    if (line.empty() || line[0] != ':') {
-        return std::nullopt;
+static bool is_line_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+HexStatus decode_hex_record(const char* begin, const char* end, HexRecordView& record, uint8_t* payload_buffer) {
+    if (begin == end || *begin != ':') {
+        return HexStatus::NotARecord;
     }
 
-    std::string hex_string = line.substr(1);
-    std::vector<uint8_t> bytes_list;
-    try {
-        for (size_t i = 0; i < hex_string.length(); i += 2) {
-            bytes_list.push_back(static_cast<uint8_t>(std::stoul(hex_string.substr(i, 2), nullptr, 16)));
-        }
-    } catch (...) {
-        return std::nullopt; // Invalid hex characters
+    const char* hex = begin + 1;
+    size_t hex_length = static_cast<size_t>(end - hex);
+    if (hex_length % 2 != 0 || hex_length / 2 < 5) {
+        return HexStatus::TooShort;
+    }
+
+    uint8_t bad = 0;
+    record.byte_count = decode_hex_pair(hex, bad);
+    if (bad & 0xF0) {
+        return HexStatus::InvalidCharacter;
+    }
+
+    // Check if the actual data length matches the byte count.
+    if (hex_length / 2 != (size_t)record.byte_count + 5) {
+        return HexStatus::LengthMismatch;
+    }
+
+    uint8_t address_hi = decode_hex_pair(hex + 2, bad);
+    uint8_t address_lo = decode_hex_pair(hex + 4, bad);
+    record.address = (address_hi << 8) | address_lo; // Combine high and low address bytes
+    record.record_type = decode_hex_pair(hex + 6, bad);
+
+    // Decode the payload, summing as we go.
+    uint8_t sum = record.byte_count + address_hi + address_lo + record.record_type;
+    if (!decode_hex_bytes(hex + 8, record.byte_count, payload_buffer, sum)) {
+        return HexStatus::InvalidCharacter;
     }
+    record.data = {payload_buffer, record.byte_count};
+    record.checksum = decode_hex_pair(hex + 8 + record.byte_count * 2, bad);
 
-    if (bytes_list.size() < 5) {
-        return std::nullopt; // Record is too short
+    if (bad & 0xF0) {
+        return HexStatus::InvalidCharacter;
     }
-    
+
     // The sum of all bytes, including the checksum, should have its lower 8 bits as zero.
-    uint8_t checksum_verify = std::accumulate(bytes_list.begin(), bytes_list.end(), 0);
-    if (checksum_verify != 0) {
-        std::cerr << "Warning: Checksum mismatch on line: " << line << std::endl;
-        // We can still parse it but warn the user.
+    if (static_cast<uint8_t>(sum + record.checksum) != 0) {
+        return HexStatus::ChecksumMismatch;
+    }
+    return HexStatus::Ok;
+}
+
+HexStatus decode_hex_record(const char* begin, const char* end, HexRecord& record) {
+    uint8_t payload[255];
+    HexRecordView view;
+    HexStatus status = decode_hex_record(begin, end, view, payload);
+    if (status == HexStatus::Ok || status == HexStatus::ChecksumMismatch) {
+        record.byte_count = view.byte_count;
+        record.address = view.address;
+        record.record_type = view.record_type;
+        record.data.assign(view.data.begin(), view.data.end());
+        record.checksum = view.checksum;
     }
-    
+    return status;
+}
+
+static void warn_checksum_mismatch(const char* begin, const char* end) {
+    std::cerr << "Warning: Checksum mismatch on line: " << std::string(begin, end) << std::endl;
+}
+
+// Implementation of the single-line parser.
+std::optional<HexRecord> parse_hex_record(const std::string& line) {
+    return parse_hex_record(line.data(), line.data() + line.size());
+}
+
+std::optional<HexRecord> parse_hex_record(const char* begin, const char* end) {
     HexRecord record;
-    record.byte_count = bytes_list[0];
+    switch (decode_hex_record(begin, end, record)) {
+        case HexStatus::Ok:
+            return record;
+        case HexStatus::ChecksumMismatch:
+            warn_checksum_mismatch(begin, end);
+            return record; // We can still parse it but warn the user.
+        default:
+            return std::nullopt;
+    }
+}
 
-    // Check if the actual data length matches the byte count.
-    if (bytes_list.size() != (size_t)record.byte_count + 5) {
-        return std::nullopt; // Malformed record
+// Scans the buffer for line boundaries and decodes each record where it lies.
+void for_each_hex_record(const char* data, size_t size, const HexRecordVisitor& visitor) {
+    uint8_t payload[255];
+    HexRecordView record;
+    const char* p = data;
+    const char* buffer_end = data + size;
+
+    while (p < buffer_end) {
+        const char* line_end = static_cast<const char*>(std::memchr(p, '\n', buffer_end - p));
+        if (!line_end) {
+            line_end = buffer_end;
+        }
+
+        // Trim whitespace just in case
+        const char* first = p;
+        const char* last = line_end;
+        while (first < last && is_line_space(*first)) ++first;
+        while (last > first && is_line_space(last[-1])) --last;
+
+        switch (decode_hex_record(first, last, record, payload)) {
+            case HexStatus::ChecksumMismatch:
+                warn_checksum_mismatch(first, last);
+                visitor(record); // We can still parse it but warn the user.
+                break;
+            case HexStatus::Ok:
+                visitor(record);
+                break;
+            default:
+                break;
+        }
+        p = line_end + 1;
     }
+}
 
-    record.address = (bytes_list[1] << 8) | bytes_list[2]; // Combine high and low address bytes
-    record.record_type = bytes_list[3];
-    record.checksum = bytes_list.back();
-    
-    // Extract the data payload.
-    record.data.assign(bytes_list.begin() + 4, bytes_list.end() - 1);
+bool for_each_hex_record_in_file(const std::string& file_path, const HexRecordVisitor& visitor) {
+    MappedFile file(file_path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << file_path << std::endl;
+        return false;
+    }
 
-    return record;
+    for_each_hex_record(file.data(), file.size(), visitor);
+    return true;
 }
 
-// Implementation of the full-file parser.
-std::vector<HexRecord> parse_hex_file(const std::string& file_path) {
+std::vector<HexRecord> parse_hex_buffer(const char* data, size_t size) {
     std::vector<HexRecord> records;
-    std::ifstream file(file_path);
-    std::string line;
+    for_each_hex_record(data, size, [&records](const HexRecordView& view) {
+        records.push_back({view.byte_count, view.address, view.record_type,
+                           std::vector<uint8_t>(view.data.begin(), view.data.end()), view.checksum});
+    });
+    return records;
+}
 
+// Implementation of the full-file parser.
+std::vector<HexRecord> parse_hex_file(const std::string& file_path) {
+    MappedFile file(file_path);
     if (!file.is_open()) {
         std::cerr << "Error: Could not open file " << file_path << std::endl;
-        return records;
+        return {};
     }
 
-    while (std::getline(file, line)) {
-        // Trim whitespace just in case
-        line.erase(0, line.find_first_not_of(" \t\r\n"));
-        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+    return parse_hex_buffer(file.data(), file.size());
+}
+
+void HexRecordSet::reserve(size_t record_count, size_t payload_bytes) {
+    headers_.reserve(record_count);
+    arena_.reserve(payload_bytes);
+}
+
+void HexRecordSet::push_back(const HexRecordView& record) {
+    headers_.push_back({arena_.size(), record.address,
+                        record.byte_count, record.record_type, record.checksum});
+    arena_.insert(arena_.end(), record.data.begin(), record.data.end());
+}
+
+void HexRecordSet::append(HexRecordSet&& other) {
+    if (empty()) {
+        *this = std::move(other);
+        return;
+    }
+    uint64_t base = arena_.size();
+    headers_.reserve(headers_.size() + other.headers_.size());
+    for (Header header : other.headers_) {
+        header.data_offset += base;
+        headers_.push_back(header);
+    }
+    arena_.insert(arena_.end(), other.arena_.begin(), other.arena_.end());
+    other.clear();
+}
+
+// Below this much text per chunk the threading overhead outweighs the gain.
+static constexpr size_t kMinParallelChunk = 256 * 1024;
+
+// Cuts the buffer into at most 'chunk_count' roughly even pieces, moving each
+// cut just past the next newline so that no record is split between chunks.
+// Returns chunk_count + 1 offsets (fewer for small inputs).
+static std::vector<size_t> split_at_lines(const char* data, size_t size, size_t chunk_count) {
+    std::vector<size_t> cuts;
+    cuts.push_back(0);
+    for (size_t i = 1; i < chunk_count; ++i) {
+        size_t cut = std::max(size / chunk_count * i, cuts.back());
+        const void* newline = std::memchr(data + cut, '\n', size - cut);
+        cut = newline ? static_cast<size_t>(static_cast<const char*>(newline) - data) + 1 : size;
+        cuts.push_back(cut);
+    }
+    cuts.push_back(size);
+    return cuts;
+}
+
+static size_t parallel_chunk_count(size_t size, unsigned thread_count) {
+    size_t chunk_count = static_cast<size_t>(resolve_thread_count(thread_count)) * 4;
+    return std::min(chunk_count, size / kMinParallelChunk);
+}
 
-        if (auto record = parse_hex_record(line)) {
-            records.push_back(*record);
+// Serial worker for parse_hex_record_set.
+static HexRecordSet parse_hex_record_set_serial(const char* data, size_t size) {
+    HexRecordSet records;
+    // A typical 16-byte record is ~45 characters of text; reserving for that
+    // avoids most regrowth without a counting pass.
+    records.reserve(size / 44 + 1, size / 44 * 16);
+    for_each_hex_record(data, size, [&records](const HexRecordView& record) {
+        records.push_back(record);
+    });
+    return records;
+}
+
+HexRecordSet parse_hex_record_set(const char* data, size_t size, unsigned thread_count,
+                                  const ProgressCallback& progress) {
+    size_t chunk_count = parallel_chunk_count(size, thread_count);
+    if (chunk_count <= 1) {
+        return parse_hex_record_set_serial(data, size);
+    }
+
+    std::vector<size_t> cuts = split_at_lines(data, size, chunk_count);
+    std::vector<HexRecordSet> chunk_records(chunk_count);
+    std::atomic<bool> cancelled{false};
+    std::mutex progress_mutex;
+    size_t finished = 0;
+    ThreadPool::shared().parallel_for(chunk_count, [&](size_t i) {
+        if (cancelled.load()) {
+            return;
+        }
+        chunk_records[i] = parse_hex_record_set_serial(data + cuts[i], cuts[i + 1] - cuts[i]);
+        if (progress) {
+            std::lock_guard<std::mutex> lock(progress_mutex);
+            if (!progress(float(++finished) / chunk_count)) {
+                cancelled = true;
+            }
         }
+    });
+    if (cancelled) {
+        return {};
     }
 
+    HexRecordSet records;
+    for (auto& chunk : chunk_records) {
+        records.append(std::move(chunk));
+    }
     return records;
 }
 
-// A new function to parse raw binary files
-std::map<uint32_t, uint8_t> parse_binary_file(const std::string& file_path, uint32_t base_address) {
-    std::map<uint32_t, uint8_t> data_map;
-    
-    // Open the file in binary mode at the end to get its size
-    std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+HexRecordSet load_hex_record_set(const std::string& file_path, unsigned thread_count,
+                                 const ProgressCallback& progress) {
+    MappedFile file(file_path);
     if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << file_path << std::endl;
+        return {};
+    }
+
+    return parse_hex_record_set(file.data(), file.size(), thread_count, progress);
+}
+
+std::optional<uint32_t> start_address_of(const HexRecordView& record) {
+    if (record.data.size < 4) {
+        return std::nullopt;
+    }
+    const uint8_t* d = record.data.data;
+    if (record.record_type == 0x03) {
+        uint32_t cs = (d[0] << 8) | d[1];
+        uint32_t ip = (d[2] << 8) | d[3];
+        return (cs << 4) + ip;
+    }
+    if (record.record_type == 0x05) {
+        return (uint32_t(d[0]) << 24) | (d[1] << 16) | (d[2] << 8) | d[3];
+    }
+    return std::nullopt;
+}
+
+std::optional<uint32_t> find_start_address(const HexRecordSet& records) {
+    std::optional<uint32_t> start;
+    for (const HexRecordView& record : records) {
+        if (std::optional<uint32_t> address = start_address_of(record)) {
+            start = address;
+        }
+    }
+    return start;
+}
+
+bool BinaryView::open(const std::string& file_path, const BinaryLoadOptions& options) {
+    segment_ = {options.base_address, 0, nullptr};
+    if (!file_.open(file_path)) {
         std::cerr << "ERROR: Could not open binary file: " << file_path << std::endl;
-        return data_map; 
+        return false;
+    }
+    if (options.file_offset > file_.size()) {
+        file_.close();
+        return false;
     }
 
-    //std::streamsize size = file.tellg();
-    file.seekg(base_address, std::ios::beg);
+    // Clamp the window to the end of the file and to the top of the address space.
+    uint64_t available = file_.size() - options.file_offset;
+    uint64_t length = std::min(options.length.value_or(available), available);
+    length = std::min<uint64_t>(length, 0x100000000ull - options.base_address);
 
-    char byte_buffer = 0;
-    uint32_t current_address = base_address;
-    while (file.get(byte_buffer)){
-        data_map[current_address] = static_cast<uint8_t>(byte_buffer);
-        current_address++;
+    segment_.length = static_cast<size_t>(length);
+    segment_.data = reinterpret_cast<const uint8_t*>(file_.data()) + options.file_offset;
+    return true;
+}
+
+MemoryImage load_binary_image(const std::string& file_path, const BinaryLoadOptions& options) {
+    MemoryImage image;
+    BinaryView view;
+    if (view.open(file_path, options)) {
+        const MemorySegment& window = view.segment();
+        image.write_block(window.start, window.data, window.length);
+        image.compact();
     }
-    /*
-    // Read the whole file into a buffer
-    std::vector<char> buffer(size);
-    if (file.read(buffer.data(), size)) {
-        // Populate the memory map with the file data
-        for (int i = 0; i < size; ++i) {
-            data_map[base_address + i] = static_cast<uint8_t>(buffer[i]);
+    return image;
+}
+
+// A new function to parse raw binary files
+MemoryImage parse_binary_file(const std::string& file_path, uint32_t base_address) {
+    BinaryLoadOptions options;
+    options.file_offset = base_address;
+    options.base_address = base_address;
+    return load_binary_image(file_path, options);
+}
+
+uint32_t find_rom_start_offset(ByteSpan bytes, uint8_t fill) {
+    size_t offset = find_first_not_fill(bytes, fill);
+    // If the data is all fill or empty, start at the beginning.
+    return offset == bytes.size ? 0 : static_cast<uint32_t>(offset);
+}
+
+uint32_t find_rom_start_offset(const std::string& file_path, uint8_t fill) {
+    BinaryView view;
+    if (!view.open(file_path)) {
+        return 0; // Return 0 if file can't be opened.
+    }
+    return find_rom_start_offset(view.segment().bytes(), fill);
+}
+
+uint32_t find_rom_end_offset(ByteSpan bytes, uint8_t fill) {
+    return static_cast<uint32_t>(find_last_not_fill_end(bytes, fill));
+}
+
+MemoryImage load_rom_image(const std::string& file_path, uint8_t fill, RomFillInfo* fill_info) {
+    MemoryImage image;
+    BinaryView view;
+    if (view.open(file_path)) {
+        const MemorySegment& file = view.segment();
+        uint32_t start = find_rom_start_offset(file.bytes(), fill);
+        image.write_block(start, file.data + start, file.length - start);
+        image.compact();
+        if (fill_info) {
+            fill_info->leading = start;
+            fill_info->trailing = static_cast<uint32_t>(file.length - find_rom_end_offset(file.bytes(), fill));
         }
-    }*/
-    
-    return data_map;
+    }
+    return image;
 }
 
-uint32_t find_rom_start_offset(const std::string& file_path) {
+// This function is to check if a character is valid in an Intel HEX file
+static bool is_valid_hex_char(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || ( c >= 'a' && c <= 'f') || c == ':' || isspace(c);
+}
+
+FileType detect_file_type(const std::string& file_path) {
     std::ifstream file(file_path, std::ios::binary);
     if (!file.is_open()) {
-        return 0; // Return 0 if file can't be opened.
+        return FileType::Unknown; // Of handle the error appropriately
+    }
+
+    // Read the first 512 bytes for analysis
+    std::vector<char> buffer(512, 0);
+    file.read(buffer.data(), buffer.size());
+
+    if (file.gcount() == 0) {
+        return FileType::Unknown; // Empty or unreadable file
     }
 
-    uint32_t offset = 0;
-    char byte = 0;
-    while (file.get(byte)) {
-        if (byte != 0x00) {
-            // Found the first non-zero byte, this is our starting offset.
-            return offset;
+    // *** Heuristic for Intel HEX ***
+    // 1. Must start with a ':'
+    // 2. All characters should be valid hex/control characters
+    if (buffer[0] == ':') {
+        bool is_plausible_hex = true;
+        for (std::streamsize i = 0; i < file.gcount(); ++i) {
+            if (!is_valid_hex_char(buffer[i])) {
+                is_plausible_hex = false;
+                break;
+            }
+        }
+        if (is_plausible_hex) {
+            return FileType::IntelHex;
         }
-        offset++;
     }
 
-    // If the file is all zeros ore empty, return 0.
-    return 0;
+    // *** If it's not HEX, assume it's Binary for this tool ***
+    return FileType::RawBinary;
 }
@@ -0,0 +1,143 @@
+#include "HexWriter.h"
+#include "HexDecode.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// Longest possible line: ':' + 4 header bytes + 255 data bytes + checksum,
+// two digits per byte, and a CRLF.
+static constexpr size_t kMaxLineLength = 1 + (4 + 255 + 1) * 2 + 2;
+static constexpr size_t kBufferSize = 1 << 20;
+
+// Collects lines in a large buffer and passes it on whenever it fills up.
+class HexLineBuffer {
+    public:
+        HexLineBuffer(const HexTextSink& sink, bool crlf)
+            : sink_(sink), crlf_(crlf), buffer_(kBufferSize) {}
+
+        // Appends one record. 'data' may be null when 'length' is 0.
+        bool record(uint8_t type, uint16_t address, const uint8_t* data, size_t length) {
+            if (used_ + kMaxLineLength > buffer_.size() && !flush()) {
+                return false;
+            }
+            char* p = buffer_.data() + used_;
+            uint8_t sum = 0;
+            const uint8_t header[4] = {static_cast<uint8_t>(length), static_cast<uint8_t>(address >> 8),
+                                       static_cast<uint8_t>(address), type};
+            *p++ = ':';
+            encode_hex_bytes_scalar(header, 4, p, sum);
+            p += 8;
+            encode_hex_bytes(data, length, p, sum);
+            p += length * 2;
+            encode_hex_pair(static_cast<uint8_t>(-sum), p);
+            p += 2;
+            if (crlf_) {
+                *p++ = '\r';
+            }
+            *p++ = '\n';
+            used_ = static_cast<size_t>(p - buffer_.data());
+            return true;
+        }
+
+        bool flush() {
+            if (used_ == 0) {
+                return true;
+            }
+            bool ok = sink_(buffer_.data(), used_);
+            used_ = 0;
+            return ok;
+        }
+
+    private:
+        const HexTextSink& sink_;
+        bool crlf_;
+        std::vector<char> buffer_;
+        size_t used_ = 0;
+};
+
+bool encode_hex_image(const MemoryImage& memory, const HexWriteOptions& options, const HexTextSink& sink) {
+    if (options.record_size == 0) {
+        return false;
+    }
+    bool segmented = options.address_mode == HexAddressMode::Segment;
+    if (segmented && !memory.empty() && memory.max_address() > 0xFFFFF) {
+        std::cerr << "ERROR: Image does not fit in 1 MB of segment addressing." << std::endl;
+        return false;
+    }
+
+    HexLineBuffer out(sink, options.crlf);
+
+    // The upper address in effect; records start out with an upper address of 0.
+    uint32_t current_upper = 0;
+    bool announce = options.address_mode != HexAddressMode::Auto; // Explicit modes always state it once
+    auto set_upper = [&](uint32_t address) {
+        uint32_t upper = address & 0xFFFF0000;
+        if (upper == current_upper && !announce) {
+            return true;
+        }
+        current_upper = upper;
+        announce = false;
+        // 0x02 holds a paragraph (address / 16), 0x04 the top 16 address bits.
+        uint16_t value = static_cast<uint16_t>(segmented ? upper >> 4 : upper >> 16);
+        const uint8_t bytes[2] = {static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+        return out.record(segmented ? 0x02 : 0x04, 0, bytes, 2);
+    };
+
+    for (const MemorySegment& segment : memory.segments()) {
+        size_t done = 0;
+        while (done < segment.length) {
+            uint32_t address = segment.start + static_cast<uint32_t>(done);
+            if (!set_upper(address)) {
+                return false;
+            }
+            // Stop at the record size, the segment end and the next 64K boundary.
+            size_t to_boundary = 0x10000 - (address & 0xFFFF);
+            size_t length = std::min<size_t>({options.record_size, segment.length - done, to_boundary});
+            if (!out.record(0x00, static_cast<uint16_t>(address), segment.data + done, length)) {
+                return false;
+            }
+            done += length;
+        }
+    }
+
+    if (options.start_address) {
+        uint32_t start = *options.start_address;
+        uint8_t bytes[4];
+        if (segmented) {
+            // CS:IP, with CS on a 64K boundary like the 0x02 records.
+            uint16_t cs = static_cast<uint16_t>((start & 0xF0000) >> 4);
+            uint16_t ip = static_cast<uint16_t>(start & 0xFFFF);
+            bytes[0] = cs >> 8; bytes[1] = cs & 0xFF; bytes[2] = ip >> 8; bytes[3] = ip & 0xFF;
+        } else {
+            bytes[0] = start >> 24; bytes[1] = (start >> 16) & 0xFF; bytes[2] = (start >> 8) & 0xFF; bytes[3] = start & 0xFF;
+        }
+        if (!out.record(segmented ? 0x03 : 0x05, 0, bytes, 4)) {
+            return false;
+        }
+    }
+
+    return out.record(0x01, 0, nullptr, 0) && out.flush();
+}
+
+std::string hex_image_to_string(const MemoryImage& memory, const HexWriteOptions& options) {
+    std::string text;
+    encode_hex_image(memory, options, [&text](const char* data, size_t size) {
+        text.append(data, size);
+        return true;
+    });
+    return text;
+}
+
+bool write_hex_file(const std::string& file_path, const MemoryImage& memory, const HexWriteOptions& options) {
+    std::ofstream file(file_path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << file_path << std::endl;
+        return false;
+    }
+    bool ok = encode_hex_image(memory, options, [&file](const char* data, size_t size) {
+        file.write(data, static_cast<std::streamsize>(size));
+        return static_cast<bool>(file);
+    });
+    return ok && static_cast<bool>(file.flush());
+}
@@ -0,0 +1,173 @@
+#include "LoadPipeline.h"
+#include "Memory.h"
+#include <exception>
+
+LoadPipeline::LoadPipeline() : worker_([this]() { worker_loop(); }) {}
+
+LoadPipeline::~LoadPipeline() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        ++generation_; // Makes the running job bail out at its next check.
+    }
+    cv_.notify_all();
+    worker_.join();
+}
+
+const char* LoadPipeline::stage_name(LoadStage stage) {
+    switch (stage) {
+        case LoadStage::Idle:            return "Idle";
+        case LoadStage::Reading:         return "Reading file";
+        case LoadStage::Building:        return "Building memory image";
+        case LoadStage::Symbols:         return "Finding symbols";
+        case LoadStage::Disassembling:   return "Disassembling";
+        case LoadStage::CrossReferences: return "Indexing cross references";
+    }
+    return "";
+}
+
+void LoadPipeline::load(const std::string& file_path, const std::string& display_name, CpuType cpu,
+                        const CodeFlowOptions& flow) {
+    submit({0, file_path, display_name, nullptr, cpu, flow});
+}
+
+void LoadPipeline::disassemble(std::shared_ptr<const LoadedFile> file, CpuType cpu, const CodeFlowOptions& flow) {
+    submit({0, std::string(), std::string(), std::move(file), cpu, flow});
+}
+
+void LoadPipeline::submit(Request request) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        request.generation = ++generation_;
+        pending_ = std::move(request);
+        finished_.reset();
+        busy_ = true;
+        stage_ = LoadStage::Idle;
+        progress_ = 0.0f;
+    }
+    cv_.notify_all();
+}
+
+void LoadPipeline::cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    pending_.reset();
+    finished_.reset();
+    busy_ = false;
+    stage_ = LoadStage::Idle;
+}
+
+std::optional<LoadResult> LoadPipeline::take_result() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::optional<LoadResult> result = std::move(finished_);
+    finished_.reset();
+    return result;
+}
+
+void LoadPipeline::report(const Request& request, LoadStage stage, float progress) {
+    // A superseded job must not overwrite the progress of its replacement.
+    if (is_current(request)) {
+        stage_ = stage;
+        progress_ = progress;
+    }
+}
+
+void LoadPipeline::worker_loop() {
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || pending_.has_value(); });
+            if (stopping_) {
+                return;
+            }
+            request = std::move(*pending_);
+            pending_.reset();
+        }
+
+        try {
+            run(request);
+        } catch (const std::exception& e) {
+            auto failed = std::make_shared<LoadedFile>();
+            failed->filename = std::string("Error: ") + e.what();
+            std::shared_ptr<const SymbolMap> symbols(failed, &failed->symbols);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (is_current(request)) {
+                finished_ = LoadResult{std::move(failed), request.cpu, {}, std::move(symbols),
+                                       std::make_shared<const XrefIndex>()};
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        busy_ = pending_.has_value();
+        if (!busy_) {
+            stage_ = LoadStage::Idle;
+        }
+    }
+}
+
+// Runs on the worker thread. The heavy steps fan out over the shared thread
+// pool themselves; this thread only sequences them. Each step reports its
+// progress through 'stage_progress' and stops early once a newer request
+// has replaced this one.
+void LoadPipeline::run(const Request& request) {
+    std::shared_ptr<const LoadedFile> file = request.file;
+    auto stage_progress = [&](LoadStage stage) {
+        return [this, &request, stage](float done) {
+            report(request, stage, done);
+            return is_current(request);
+        };
+    };
+
+    if (!file) {
+        auto loaded = std::make_shared<LoadedFile>();
+        loaded->filename = request.display_name;
+
+        report(request, LoadStage::Reading, 0.0f);
+        loaded->type = detect_file_type(request.file_path);
+        if (loaded->type == FileType::IntelHex) {
+            loaded->records = load_hex_record_set(request.file_path, 0, stage_progress(LoadStage::Reading));
+            if (!is_current(request)) return;
+            report(request, LoadStage::Building, 0.0f);
+            loaded->memory = build_memory_map_parallel(loaded->records, 0, stage_progress(LoadStage::Building));
+            if (!is_current(request)) return;
+            loaded->conflicts = find_memory_conflicts(loaded->records);
+        } else if (loaded->type == FileType::RawBinary) {
+            loaded->memory = load_rom_image(request.file_path, 0x00, &loaded->rom_fill);
+        } else {
+            loaded->filename = "Error: Could not identify file type.";
+        }
+        if (!is_current(request)) return;
+
+        report(request, LoadStage::Symbols, 0.0f);
+        loaded->symbols = generate_symbols(loaded->memory, stage_progress(LoadStage::Symbols));
+        if (!is_current(request)) return;
+        file = std::move(loaded);
+    }
+
+    report(request, LoadStage::Disassembling, 0.0f);
+    std::unique_ptr<CpuDisassembler> disassembler = make_disassembler(request.cpu);
+    std::vector<DisassembledInstruction> disassembly;
+    // The sweep uses the labels found at load time; they live as long as the file.
+    std::shared_ptr<const SymbolMap> symbols(file, &file->symbols);
+    if (request.flow.mode == DisassemblyMode::FollowFlow) {
+        std::vector<uint32_t> entry_points =
+            collect_entry_points(file->memory, request.cpu, request.flow, find_start_address(file->records));
+        CodeMap code = analyze_code_flow(file->memory, request.cpu, entry_points);
+        if (!is_current(request)) return;
+        symbols = std::make_shared<const SymbolMap>(generate_symbols(code));
+        disassembly = disassemble_code_map(file->memory, *disassembler, code);
+    } else {
+        disassembly = disassemble_image_parallel(file->memory, *disassembler, stage_progress(LoadStage::Disassembling));
+    }
+    if (!is_current(request)) return;
+
+    report(request, LoadStage::CrossReferences, 0.0f);
+    auto xrefs = std::make_shared<const XrefIndex>(build_xrefs(file->memory, disassembly, request.cpu));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (is_current(request)) {
+        finished_ = LoadResult{std::move(file), request.cpu, std::move(disassembly), std::move(symbols),
+                               std::move(xrefs)};
+    }
+}
@@ -0,0 +1,139 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        swap(other);
+    }
+    return *this;
+}
+
+void MappedFile::swap(MappedFile& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(is_open_, other.is_open_);
+#ifdef _WIN32
+    std::swap(file_handle_, other.file_handle_);
+    std::swap(mapping_handle_, other.mapping_handle_);
+#endif
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& file_path) {
+    close();
+
+    HANDLE file = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    file_handle_ = file;
+    is_open_ = true;
+    if (file_size.QuadPart == 0) {
+        return true; // Nothing to map, but the file is valid.
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        close();
+        return false;
+    }
+    mapping_handle_ = mapping;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        close();
+        return false;
+    }
+
+    data_ = static_cast<const char*>(view);
+    size_ = static_cast<size_t>(file_size.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_handle_) {
+        CloseHandle(static_cast<HANDLE>(mapping_handle_));
+    }
+    if (file_handle_) {
+        CloseHandle(static_cast<HANDLE>(file_handle_));
+    }
+    data_ = nullptr;
+    size_ = 0;
+    is_open_ = false;
+    file_handle_ = nullptr;
+    mapping_handle_ = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& file_path) {
+    close();
+
+    int fd = ::open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    is_open_ = true;
+    if (st.st_size == 0) {
+        ::close(fd);
+        return true; // Nothing to map, but the file is valid.
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps its own reference to the file.
+    if (view == MAP_FAILED) {
+        is_open_ = false;
+        return false;
+    }
+    madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+    data_ = static_cast<const char*>(view);
+    size_ = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    is_open_ = false;
+}
+
+#endif
@@ -1,30 +1,188 @@
 #include "Memory.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 
-MemoryMap build_memory_map(const std::vector<HexRecord>& records) {
-    MemoryMap memory;
-    uint32_t high_address = 0; // Stores the upper 16 bits of the address
-
-    for (const auto& record : records) {
-        switch (record.record_type) {
-            case 0x00: { // Data Record
-                uint32_t current_address = high_address + record.address;
-                for (uint8_t byte : record.data) {
-                    memory[current_address++] = byte;
-                }
-                break;
+// Updates the running upper address if this is an 0x02/0x04 record.
+// Returns true if the record changed the address state.
+static bool apply_extended_address(const HexRecordView& record, uint32_t& high_address) {
+    if (record.data.size < 2) {
+        return false;
+    }
+    switch (record.record_type) {
+        case 0x02: // Extended Segment Address Record (rarely used, but good to have)
+            high_address = ((record.data[0] << 8) | record.data[1]) << 4;
+            return true;
+        case 0x04: // Extended Linear Address Record
+            high_address = ((record.data[0] << 8) | record.data[1]) << 16;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Applies one record to the image being built.
+static void apply_record(MemoryImage& memory, const HexRecordView& record, uint32_t& high_address) {
+    if (record.record_type == 0x00) { // Data Record
+        // One bulk copy per record; the image splits it at page boundaries and
+        // coalesces it with the previous record's extent when they are adjacent.
+        memory.write_block(high_address + record.address, record.data.data, record.data.size);
+    } else {
+        // Other record types (01, 03, 05) don't contain data for the memory map
+        apply_extended_address(record, high_address);
+    }
+}
+
+// Uniform indexed access to both record containers.
+static HexRecordView record_at(const std::vector<HexRecord>& records, size_t index) {
+    return view_of(records[index]);
+}
+
+static HexRecordView record_at(const HexRecordSet& records, size_t index) {
+    return records[index];
+}
+
+// Writes records [first, last) into 'memory', starting from the given upper address.
+template <typename Records>
+static void apply_records(MemoryImage& memory, const Records& records, size_t first, size_t last, uint32_t high_address) {
+    for (size_t i = first; i < last; ++i) {
+        apply_record(memory, record_at(records, i), high_address);
+    }
+}
+
+MemoryImage build_memory_map(const std::vector<HexRecord>& records) {
+    MemoryImage memory;
+    apply_records(memory, records, 0, records.size(), 0);
+    memory.compact(); // HEX records may arrive in any address order
+    return memory;
+}
+
+MemoryImage build_memory_map(const HexRecordSet& records) {
+    MemoryImage memory;
+    apply_records(memory, records, 0, records.size(), 0);
+    memory.compact(); // HEX records may arrive in any address order
+    return memory;
+}
+
+// Applies one streamed record and notes what the fused loader reports.
+static void apply_streamed_record(MemoryImage& memory, const HexRecordView& record, uint32_t& high_address,
+                                  HexLoadInfo& info) {
+    apply_record(memory, record, high_address);
+    ++info.records;
+    if (std::optional<uint32_t> start = start_address_of(record)) {
+        info.start_address = start;
+    }
+}
+
+MemoryImage build_memory_map_from_buffer(const char* data, size_t size, HexLoadInfo* info) {
+    MemoryImage memory;
+    HexLoadInfo seen;
+    seen.opened = true;
+    uint32_t high_address = 0;
+    for_each_hex_record(data, size, [&](const HexRecordView& record) {
+        apply_streamed_record(memory, record, high_address, seen);
+    });
+    memory.compact(); // HEX records may arrive in any address order
+    if (info) {
+        *info = seen;
+    }
+    return memory;
+}
+
+MemoryImage load_hex_memory_map(const std::string& file_path, HexLoadInfo* info) {
+    MemoryImage memory;
+    HexLoadInfo seen;
+    uint32_t high_address = 0;
+    seen.opened = for_each_hex_record_in_file(file_path, [&](const HexRecordView& record) {
+        apply_streamed_record(memory, record, high_address, seen);
+    });
+    memory.compact(); // HEX records may arrive in any address order
+    if (info) {
+        *info = seen;
+    }
+    return memory;
+}
+
+// Below this many records per chunk a serial build is faster.
+static constexpr size_t kMinParallelRecords = 16 * 1024;
+
+template <typename Records>
+static MemoryImage build_memory_map_chunked(const Records& records, unsigned thread_count,
+                                            const ProgressCallback& progress) {
+    size_t chunk_count = std::min(static_cast<size_t>(resolve_thread_count(thread_count)),
+                                  records.size() / kMinParallelRecords);
+    if (chunk_count <= 1 && !progress) {
+        return build_memory_map(records);
+    }
+    if (chunk_count <= 1) {
+        // Serial, but a slice of records at a time so progress can be reported.
+        MemoryImage memory;
+        uint32_t high_address = 0;
+        for (size_t first = 0; first < records.size(); first += kMinParallelRecords) {
+            if (!progress(float(first) / records.size())) {
+                return {};
             }
-            case 0x02: { // Extended Segment Address Record (rarely used, but good to have)
-                high_address = ((record.data[0] << 8) | record.data[1]) << 4;
-                break;
+            size_t last = std::min(records.size(), first + kMinParallelRecords);
+            for (size_t i = first; i < last; ++i) {
+                apply_record(memory, record_at(records, i), high_address);
             }
-            case 0x04: { // Extended Linear Address Record
-                high_address = ((record.data[0] << 8) | record.data[1]) << 16;
-                break;
+        }
+        memory.compact(); // HEX records may arrive in any address order
+        return memory;
+    }
+
+    // Prefix pass: only the 02/04 records matter, so each chunk's starting
+    // upper address is the last one set by any earlier chunk.
+    size_t chunk_size = (records.size() + chunk_count - 1) / chunk_count;
+    std::vector<uint32_t> start_address(chunk_count, 0);
+    uint32_t high_address = 0;
+    for (size_t i = 0; i < chunk_count; ++i) {
+        start_address[i] = high_address;
+        size_t end = std::min(records.size(), (i + 1) * chunk_size);
+        for (size_t r = i * chunk_size; r < end; ++r) {
+            apply_extended_address(record_at(records, r), high_address);
+        }
+    }
+
+    std::vector<MemoryImage> partial(chunk_count);
+    std::atomic<bool> cancelled{false};
+    std::mutex progress_mutex;
+    size_t finished = 0;
+    ThreadPool::shared().parallel_for(chunk_count, [&](size_t i) {
+        if (cancelled.load()) {
+            return;
+        }
+        size_t first = std::min(records.size(), i * chunk_size);
+        size_t last = std::min(records.size(), (i + 1) * chunk_size);
+        apply_records(partial[i], records, first, last, start_address[i]);
+        if (progress) {
+            std::lock_guard<std::mutex> lock(progress_mutex);
+            if (!progress(float(++finished) / chunk_count)) {
+                cancelled = true;
             }
-            // Other record types (01, 03, 05) don't contain data for the memory map
-            default:
-                break;
         }
+    });
+    if (cancelled) {
+        return {};
     }
+
+    // Overlay in record order, so a later record still wins over an earlier
+    // one, just like the serial path.
+    MemoryImage memory = std::move(partial.front());
+    for (size_t i = 1; i < chunk_count; ++i) {
+        memory.overlay(partial[i]);
+    }
+    memory.compact(); // HEX records may arrive in any address order
     return memory;
 }
+
+MemoryImage build_memory_map_parallel(const std::vector<HexRecord>& records, unsigned thread_count,
+                                      const ProgressCallback& progress) {
+    return build_memory_map_chunked(records, thread_count, progress);
+}
+
+MemoryImage build_memory_map_parallel(const HexRecordSet& records, unsigned thread_count,
+                                      const ProgressCallback& progress) {
+    return build_memory_map_chunked(records, thread_count, progress);
+}
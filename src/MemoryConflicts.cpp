@@ -0,0 +1,136 @@
+#include "MemoryConflicts.h"
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+// A data record resolved to its absolute address range [start, end).
+struct RecordInterval {
+    uint64_t start;
+    uint64_t end;
+    RecordRef source;
+    const uint8_t* data;
+};
+
+// A static interval tree: the intervals are sorted by start and viewed as an
+// implicit balanced binary tree (the middle element of each range is the
+// node), with every node caching the largest end in its subtree.
+class IntervalIndex {
+    public:
+        explicit IntervalIndex(std::vector<RecordInterval> intervals)
+            : items_(std::move(intervals)), max_end_(items_.size()) {
+            std::sort(items_.begin(), items_.end(),
+                      [](const RecordInterval& a, const RecordInterval& b) { return a.start < b.start; });
+            build(0, items_.size());
+        }
+
+        const std::vector<RecordInterval>& items() const { return items_; }
+
+        // Calls visit(interval) for every interval overlapping [start, end).
+        template <typename Visit>
+        void query(uint64_t start, uint64_t end, Visit&& visit) const {
+            query(0, items_.size(), start, end, visit);
+        }
+
+    private:
+        uint64_t build(size_t lo, size_t hi) {
+            if (lo >= hi) {
+                return 0;
+            }
+            size_t mid = lo + (hi - lo) / 2;
+            max_end_[mid] = std::max({items_[mid].end, build(lo, mid), build(mid + 1, hi)});
+            return max_end_[mid];
+        }
+
+        template <typename Visit>
+        void query(size_t lo, size_t hi, uint64_t start, uint64_t end, Visit& visit) const {
+            if (lo >= hi) {
+                return;
+            }
+            size_t mid = lo + (hi - lo) / 2;
+            if (max_end_[mid] <= start) {
+                return; // Nothing in this subtree reaches the query.
+            }
+            query(lo, mid, start, end, visit);
+            if (items_[mid].start >= end) {
+                return; // This node and everything right of it start too late.
+            }
+            if (items_[mid].end > start) {
+                visit(items_[mid]);
+            }
+            query(mid + 1, hi, start, end, visit);
+        }
+
+        std::vector<RecordInterval> items_;
+        std::vector<uint64_t> max_end_;
+};
+
+static bool comes_before(const RecordRef& a, const RecordRef& b) {
+    return std::tie(a.input, a.record) < std::tie(b.input, b.record);
+}
+
+// Resolves every non-empty data record of every input to an absolute range.
+static std::vector<RecordInterval> collect_intervals(const std::vector<const HexRecordSet*>& inputs) {
+    std::vector<RecordInterval> intervals;
+    for (uint32_t input = 0; input < inputs.size(); ++input) {
+        const HexRecordSet& records = *inputs[input];
+        uint32_t high_address = 0;
+        for (uint32_t index = 0; index < records.size(); ++index) {
+            HexRecordView record = records[index];
+            if (record.record_type == 0x00 && !record.data.empty()) {
+                uint64_t start = uint64_t(high_address) + record.address;
+                intervals.push_back({start, start + record.data.size, {input, index}, record.data.data});
+            } else if (record.data.size >= 2 && record.record_type == 0x02) {
+                high_address = ((record.data[0] << 8) | record.data[1]) << 4;
+            } else if (record.data.size >= 2 && record.record_type == 0x04) {
+                high_address = ((record.data[0] << 8) | record.data[1]) << 16;
+            }
+        }
+    }
+    return intervals;
+}
+
+std::vector<MemoryConflict> find_memory_conflicts(const std::vector<const HexRecordSet*>& inputs) {
+    IntervalIndex index(collect_intervals(inputs));
+
+    // Clean images are the common case: one linear pass over the sorted
+    // intervals proves there is nothing to report.
+    bool any_overlap = false;
+    uint64_t reach = 0;
+    for (const RecordInterval& interval : index.items()) {
+        if (interval.start < reach) {
+            any_overlap = true;
+            break;
+        }
+        reach = std::max(reach, interval.end);
+    }
+    std::vector<MemoryConflict> conflicts;
+    if (!any_overlap) {
+        return conflicts;
+    }
+
+    for (const RecordInterval& later : index.items()) {
+        index.query(later.start, later.end, [&](const RecordInterval& earlier) {
+            // Each pair is seen from both sides; keep it once, from the later record.
+            if (!comes_before(earlier.source, later.source)) {
+                return;
+            }
+            uint64_t start = std::max(earlier.start, later.start);
+            uint64_t end = std::min(earlier.end, later.end);
+            bool identical = std::memcmp(earlier.data + (start - earlier.start),
+                                         later.data + (start - later.start), end - start) == 0;
+            conflicts.push_back({static_cast<uint32_t>(start), static_cast<uint32_t>(end - start),
+                                 earlier.source, later.source, identical});
+        });
+    }
+
+    std::sort(conflicts.begin(), conflicts.end(), [](const MemoryConflict& a, const MemoryConflict& b) {
+        if (a.address != b.address) return a.address < b.address;
+        if (comes_before(a.earlier, b.earlier) || comes_before(b.earlier, a.earlier)) return comes_before(a.earlier, b.earlier);
+        return comes_before(a.later, b.later);
+    });
+    return conflicts;
+}
+
+std::vector<MemoryConflict> find_memory_conflicts(const HexRecordSet& records) {
+    return find_memory_conflicts(std::vector<const HexRecordSet*>{&records});
+}
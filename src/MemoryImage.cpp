@@ -0,0 +1,317 @@
+#include "MemoryImage.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// Bit helpers; the fallbacks only matter for non-GCC compilers.
+static inline int count_trailing_zeros(uint64_t value) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(value);
+#else
+    int count = 0;
+    while (!(value & 1)) { value >>= 1; ++count; }
+    return count;
+#endif
+}
+
+static inline int count_set_bits(uint64_t value) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(value);
+#else
+    int count = 0;
+    for (; value; value &= value - 1) ++count;
+    return count;
+#endif
+}
+
+void MemoryImage::clear() {
+    directory_.clear();
+    bytes_.clear();
+    present_.clear();
+    slot_page_.clear();
+    in_order_ = true;
+    extents_.clear();
+    byte_count_ = 0;
+    min_address_ = 0xFFFFFFFF;
+    max_address_ = 0;
+}
+
+uint32_t MemoryImage::get_or_create_slot(uint32_t page) {
+    uint32_t top = page >> kLeafBits;
+    if (top >= directory_.size()) {
+        directory_.resize(top + 1);
+    }
+    if (!directory_[top]) {
+        directory_[top] = std::make_unique<Leaf>();
+        directory_[top]->fill(kNoSlot);
+    }
+    uint32_t& slot = (*directory_[top])[page & (kLeafSize - 1)];
+    if (slot == kNoSlot) {
+        slot = static_cast<uint32_t>(present_.size());
+        if (!slot_page_.empty() && page < slot_page_.back()) {
+            in_order_ = false;
+        }
+        slot_page_.push_back(page);
+        present_.push_back(PageBits{});
+        bytes_.resize(bytes_.size() + kPageSize);
+    }
+    return slot;
+}
+
+void MemoryImage::write(uint32_t address, uint8_t value) {
+    uint32_t slot = get_or_create_slot(address >> kPageBits);
+    uint32_t offset = address & (kPageSize - 1);
+    uint64_t& word = present_[slot][offset >> 6];
+    uint64_t bit = uint64_t(1) << (offset & 63);
+    if (!(word & bit)) {
+        word |= bit;
+        ++byte_count_;
+        min_address_ = std::min(min_address_, address);
+        max_address_ = std::max(max_address_, address);
+        add_extent(address, 1);
+    }
+    bytes_[static_cast<size_t>(slot) * kPageSize + offset] = value;
+}
+
+// Sets bits [first, last) of a page bitmap. Returns how many were newly set.
+static size_t set_bit_range(std::array<uint64_t, MemoryImage::kPageSize / 64>& bits, uint32_t first, uint32_t last) {
+    size_t added = 0;
+    while (first < last) {
+        uint32_t word = first >> 6;
+        uint32_t lo = first & 63;
+        uint32_t hi = std::min<uint32_t>(64, lo + (last - first));
+        uint64_t mask = (hi == 64 ? ~uint64_t(0) : ((uint64_t(1) << hi) - 1)) & (~uint64_t(0) << lo);
+        added += count_set_bits(mask & ~bits[word]);
+        bits[word] |= mask;
+        first += hi - lo;
+    }
+    return added;
+}
+
+void MemoryImage::write_block(uint32_t address, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        // Never let one pass run past the top of the address space.
+        size_t chunk_length = static_cast<size_t>(std::min<uint64_t>(length, 0x100000000ull - address));
+        uint32_t chunk_start = address;
+
+        size_t done = 0;
+        while (done < chunk_length) {
+            uint32_t current = chunk_start + static_cast<uint32_t>(done);
+            uint32_t offset = current & (kPageSize - 1);
+            size_t count = std::min<size_t>(kPageSize - offset, chunk_length - done);
+            uint32_t slot = get_or_create_slot(current >> kPageBits);
+            std::memcpy(bytes_.data() + static_cast<size_t>(slot) * kPageSize + offset, data + done, count);
+            byte_count_ += set_bit_range(present_[slot], offset, offset + static_cast<uint32_t>(count));
+            done += count;
+        }
+
+        uint32_t chunk_last = chunk_start + static_cast<uint32_t>(chunk_length - 1);
+        min_address_ = std::min(min_address_, chunk_start);
+        max_address_ = std::max(max_address_, chunk_last);
+        add_extent(chunk_start, chunk_length);
+
+        data += chunk_length;
+        length -= chunk_length;
+        address = 0;
+    }
+}
+
+void MemoryImage::add_extent(uint32_t start, size_t length) {
+    uint64_t end = uint64_t(start) + length;
+
+    // Fast path: records usually arrive in address order.
+    if (extents_.empty() || start > extents_.back().end()) {
+        extents_.push_back({start, length});
+        return;
+    }
+    if (start >= extents_.back().start) {
+        Extent& last = extents_.back();
+        last.length = static_cast<size_t>(std::max(end, last.end()) - last.start);
+        return;
+    }
+
+    // General case: merge with every extent that overlaps or touches [start, end).
+    auto first = std::lower_bound(extents_.begin(), extents_.end(), start,
+                                  [](const Extent& e, uint32_t value) { return e.end() < value; });
+    auto last = std::upper_bound(first, extents_.end(), end,
+                                 [](uint64_t value, const Extent& e) { return value < e.start; });
+    if (first == last) {
+        extents_.insert(first, {start, length});
+        return;
+    }
+    uint32_t merged_start = std::min(start, first->start);
+    uint64_t merged_end = std::max(end, std::prev(last)->end());
+    *first = {merged_start, static_cast<size_t>(merged_end - merged_start)};
+    extents_.erase(std::next(first), last);
+}
+
+// First extent that ends after 'address' (it may start above it).
+std::vector<MemoryImage::Extent>::const_iterator MemoryImage::extent_at_or_after(uint32_t address) const {
+    return std::upper_bound(extents_.begin(), extents_.end(), address,
+                            [](uint32_t value, const Extent& e) { return value < e.end(); });
+}
+
+std::optional<uint32_t> MemoryImage::next_present(uint32_t address) const {
+    auto it = extent_at_or_after(address);
+    if (it == extents_.end()) {
+        return std::nullopt;
+    }
+    return std::max(address, it->start);
+}
+
+void MemoryImage::compact() {
+    if (in_order_) {
+        return;
+    }
+    std::vector<uint32_t> order(slot_page_.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return slot_page_[a] < slot_page_[b]; });
+
+    std::vector<uint8_t> bytes(bytes_.size());
+    std::vector<PageBits> present(present_.size());
+    std::vector<uint32_t> slot_page(slot_page_.size());
+    for (uint32_t new_slot = 0; new_slot < order.size(); ++new_slot) {
+        uint32_t old_slot = order[new_slot];
+        uint32_t page = slot_page_[old_slot];
+        std::memcpy(bytes.data() + static_cast<size_t>(new_slot) * kPageSize,
+                    bytes_.data() + static_cast<size_t>(old_slot) * kPageSize, kPageSize);
+        present[new_slot] = present_[old_slot];
+        slot_page[new_slot] = page;
+        (*directory_[page >> kLeafBits])[page & (kLeafSize - 1)] = new_slot;
+    }
+    bytes_ = std::move(bytes);
+    present_ = std::move(present);
+    slot_page_ = std::move(slot_page);
+    in_order_ = true;
+}
+
+void MemoryImage::require_compact() const {
+    if (!in_order_) {
+        throw std::logic_error("MemoryImage: segments queried before compact()");
+    }
+}
+
+// With the slots in address order, consecutive pages sit in consecutive
+// slots, so an extent's bytes start at its first byte and run contiguously.
+MemorySegment MemoryImage::make_segment(const Extent& extent) const {
+    uint32_t slot = find_slot(extent.start >> kPageBits);
+    const uint8_t* data = bytes_.data() + static_cast<size_t>(slot) * kPageSize + (extent.start & (kPageSize - 1));
+    return {extent.start, extent.length, data};
+}
+
+std::vector<MemorySegment> MemoryImage::segments() const {
+    require_compact();
+    std::vector<MemorySegment> result;
+    result.reserve(extents_.size());
+    for (const Extent& extent : extents_) {
+        result.push_back(make_segment(extent));
+    }
+    return result;
+}
+
+std::optional<MemorySegment> MemoryImage::find_segment(uint32_t address) const {
+    auto it = extent_at_or_after(address);
+    if (it == extents_.end() || it->start > address) {
+        return std::nullopt;
+    }
+    require_compact();
+    return make_segment(*it);
+}
+
+ByteSpan MemoryImage::span_at(uint32_t address) const {
+    uint32_t slot = find_slot(address >> kPageBits);
+    uint32_t offset = address & (kPageSize - 1);
+    if (slot == kNoSlot || !test_bit(slot, offset)) {
+        return {};
+    }
+
+    // Find the first missing byte at or after 'offset' within the page.
+    const PageBits& bits = present_[slot];
+    uint32_t end = kPageSize;
+    for (uint32_t w = offset >> 6; w < bits.size(); ++w) {
+        uint64_t missing = ~bits[w];
+        if (w == (offset >> 6)) {
+            missing &= ~uint64_t(0) << (offset & 63);
+        }
+        if (missing) {
+            end = (w << 6) | count_trailing_zeros(missing);
+            break;
+        }
+    }
+    return {bytes_.data() + static_cast<size_t>(slot) * kPageSize + offset, end - offset};
+}
+
+void MemoryImage::overlay(const MemoryImage& other) {
+    for (uint32_t top = 0; top < other.directory_.size(); ++top) {
+        if (!other.directory_[top]) {
+            continue;
+        }
+        for (uint32_t index = 0; index < kLeafSize; ++index) {
+            uint32_t other_slot = (*other.directory_[top])[index];
+            if (other_slot == kNoSlot) {
+                continue;
+            }
+            uint32_t page = (top << kLeafBits) | index;
+            uint32_t slot = get_or_create_slot(page);
+            const uint8_t* src = other.bytes_.data() + static_cast<size_t>(other_slot) * kPageSize;
+            uint8_t* dst = bytes_.data() + static_cast<size_t>(slot) * kPageSize;
+            const PageBits& src_bits = other.present_[other_slot];
+            PageBits& dst_bits = present_[slot];
+
+            for (uint32_t w = 0; w < src_bits.size(); ++w) {
+                uint64_t bits = src_bits[w];
+                if (bits == ~uint64_t(0)) {
+                    std::memcpy(dst + w * 64, src + w * 64, 64);
+                } else {
+                    for (uint64_t rest = bits; rest; rest &= rest - 1) {
+                        uint32_t i = w * 64 + count_trailing_zeros(rest);
+                        dst[i] = src[i];
+                    }
+                }
+                byte_count_ += count_set_bits(bits & ~dst_bits[w]);
+                dst_bits[w] |= bits;
+            }
+        }
+    }
+    for (const Extent& extent : other.extents_) {
+        add_extent(extent.start, extent.length);
+    }
+    if (!other.empty()) {
+        min_address_ = std::min(min_address_, other.min_address_);
+        max_address_ = std::max(max_address_, other.max_address_);
+    }
+}
+
+MemoryImage::const_iterator::const_iterator(const MemoryImage* image, std::optional<uint32_t> address)
+    : image_(image) {
+    if (address) {
+        ByteSpan run = image_->span_at(*address);
+        run_ = run.data;
+        run_left_ = run.size;
+        current_ = {*address, *run_};
+        at_end_ = false;
+    }
+}
+
+MemoryImage::const_iterator& MemoryImage::const_iterator::operator++() {
+    // Step within the current page run; only look up the image at its end.
+    if (run_left_ > 1) {
+        ++run_;
+        --run_left_;
+        current_ = {current_.first + 1, *run_};
+        return *this;
+    }
+    std::optional<uint32_t> next;
+    if (current_.first != 0xFFFFFFFF) {
+        next = image_->next_present(current_.first + 1);
+    }
+    if (next) {
+        *this = const_iterator(image_, next);
+    } else {
+        at_end_ = true;
+        run_left_ = 0;
+    }
+    return *this;
+}
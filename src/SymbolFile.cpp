@@ -0,0 +1,453 @@
+#include "SymbolFile.h"
+#include "MappedFile.h"
+#include "OpcodeTable.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+SymbolFileFormat symbol_format_for_path(const std::string& file_path) {
+    size_t dot = file_path.find_last_of('.');
+    size_t slash = file_path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return SymbolFileFormat::Equates;
+    }
+    std::string extension = file_path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == "sym") {
+        return SymbolFileFormat::CpmSym;
+    }
+    if (extension == "lst" || extension == "prn") {
+        return SymbolFileFormat::Listing;
+    }
+    if (extension == "map") {
+        return SymbolFileFormat::Map;
+    }
+    return SymbolFileFormat::Equates;
+}
+
+namespace {
+
+// Character classes, looked up once per character by the tokenizer.
+enum CharClass : uint8_t {
+    kBlank     = 1 << 0, // Separates words
+    kNameStart = 1 << 1, // May start a name
+    kNameChar  = 1 << 2  // May appear in a name
+};
+
+constexpr std::array<uint8_t, 256> make_char_classes() {
+    std::array<uint8_t, 256> classes{};
+    for (char c : {' ', '\t', ',', '\r', '\f', '\x1A'}) {
+        classes[static_cast<uint8_t>(c)] = kBlank;
+    }
+    for (int c = 0; c < 256; ++c) {
+        bool letter = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+        if (letter || c == '_' || c == '?' || c == '@' || c == '.') {
+            classes[c] |= kNameStart | kNameChar;
+        }
+        if ((c >= '0' && c <= '9') || c == '$') {
+            classes[c] |= kNameChar;
+        }
+    }
+    return classes;
+}
+
+constexpr std::array<uint8_t, 256> char_classes = make_char_classes();
+
+bool has_class(char c, CharClass which) {
+    return char_classes[static_cast<uint8_t>(c)] & which;
+}
+
+// A word of the text, [begin, end).
+struct Token {
+    const char* begin;
+    const char* end;
+
+    size_t size() const { return static_cast<size_t>(end - begin); }
+    std::string_view view() const { return {begin, size()}; }
+};
+
+// Splits one line into words at blanks and commas. '=' is a word of its
+// own, and a ';' starts a comment that runs to the end of the line. 0x1A
+// (the CP/M end-of-file mark) counts as a blank.
+class LineTokens {
+    public:
+        LineTokens(const char* begin, const char* end) : begin_(begin), p_(begin), end_(end) {}
+
+        // True if 'token' starts in the first column of the line.
+        bool starts_line(Token token) const { return token.begin == begin_; }
+
+        bool next(Token& token) {
+            while (p_ < end_ && is_blank(*p_)) {
+                ++p_;
+            }
+            if (p_ == end_ || *p_ == ';') {
+                return false;
+            }
+            token.begin = p_;
+            if (*p_ == '=') {
+                ++p_;
+            } else {
+                while (p_ < end_ && !is_blank(*p_) && *p_ != ';' && *p_ != '=') {
+                    ++p_;
+                }
+            }
+            token.end = p_;
+            return true;
+        }
+
+    private:
+        static bool is_blank(char c) { return has_class(c, kBlank); }
+
+        const char* begin_;
+        const char* p_;
+        const char* end_;
+};
+
+// Value of an ASCII digit in any base up to 16, or 255.
+int digit_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return 255;
+}
+
+// Reads 0100H, 0x0100, $0100 or a bare 0100 (hex if 'bare_is_hex', else
+// decimal, with the assemblers' Q/O octal and B binary suffixes).
+bool parse_number(Token token, bool bare_is_hex, uint32_t& value) {
+    const char* p = token.begin;
+    const char* e = token.end;
+    if (p == e) {
+        return false;
+    }
+    int base = bare_is_hex ? 16 : 10;
+    char suffix = static_cast<char>(std::toupper(static_cast<unsigned char>(e[-1])));
+    if (e - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+        p += 2;
+        base = 16;
+    } else if (*p == '$') {
+        ++p;
+        base = 16;
+    } else if (e - p > 1 && suffix == 'H') {
+        --e;
+        base = 16;
+    } else if (!bare_is_hex && e - p > 1 && (suffix == 'Q' || suffix == 'O')) {
+        --e;
+        base = 8;
+    } else if (!bare_is_hex && e - p > 1 && suffix == 'B') {
+        --e;
+        base = 2;
+    }
+    if (p == e) {
+        return false;
+    }
+    uint64_t result = 0;
+    for (; p < e; ++p) {
+        int digit = digit_value(*p);
+        if (digit >= base) {
+            return false;
+        }
+        result = result * base + digit;
+        if (result > 0xFFFFFFFF) {
+            return false;
+        }
+    }
+    value = static_cast<uint32_t>(result);
+    return true;
+}
+
+bool is_name(Token token) {
+    if (token.begin == token.end || !has_class(*token.begin, kNameStart)) {
+        return false;
+    }
+    return std::all_of(token.begin + 1, token.end, [](char c) { return has_class(c, kNameChar); });
+}
+
+// Drops a label's trailing ':'. Returns true if there was one.
+bool strip_colon(Token& token) {
+    if (token.begin < token.end && token.end[-1] == ':') {
+        --token.end;
+        return true;
+    }
+    return false;
+}
+
+bool is_equate_keyword(Token token) {
+    static const char* const keywords[] = {"=", "EQU", ".EQU", "SET", ".SET", "DEFL"};
+    for (const char* keyword : keywords) {
+        size_t length = std::strlen(keyword);
+        if (token.size() == length &&
+            std::equal(token.begin, token.end, keyword, [](char a, char b) {
+                return std::toupper(static_cast<unsigned char>(a)) == b;
+            })) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// A bare hex word that can stand before a name in a map: it starts with a
+// digit or has 4 digits, so that ordinary words like "BAD" are not taken.
+bool looks_like_address(Token token) {
+    return token.size() == 4 || (token.begin < token.end && std::isdigit(static_cast<unsigned char>(*token.begin)));
+}
+
+// A number written the way an address is: 4 hex digits, 0100H, 0x0100 or
+// $0100. A small operand such as the 10 of "CPI 10" is none of these.
+bool is_address_number(Token token, uint32_t& value) {
+    if (!parse_number(token, true, value)) {
+        return false;
+    }
+    char suffix = static_cast<char>(std::toupper(static_cast<unsigned char>(token.end[-1])));
+    bool prefixed = *token.begin == '$' || (token.size() > 2 && token.begin[0] == '0' && (token.begin[1] | 0x20) == 'x');
+    return token.size() == 4 || suffix == 'H' || prefixed;
+}
+
+// True for 8080/8085 mnemonics and assembler directives, which start the
+// lines of code an equates file may share with its equates.
+bool is_reserved_word(Token token) {
+    static const char* const directives[] = {"DB", "DW", "DS", "ORG", "END", "IF", "ENDIF", "ELSE", "MACRO",
+                                             "ENDM", "TITLE", "PAGE", "DEFB", "DEFW", "DEFS", "PUBLIC", "EXTRN"};
+    auto same_word = [&](const char* word) {
+        return token.size() == std::strlen(word) &&
+               std::equal(token.begin, token.end, word,
+                          [](char a, char b) { return std::toupper(static_cast<unsigned char>(a)) == b; });
+    };
+    return std::any_of(std::begin(mnemonic_names), std::end(mnemonic_names), same_word) ||
+           std::any_of(std::begin(directives), std::end(directives), same_word);
+}
+
+using NameList = std::vector<std::pair<uint32_t, std::string_view>>;
+
+// "0100 START 0103 LOOP ..."
+void parse_cpm_sym_line(LineTokens tokens, NameList& names) {
+    Token address, name;
+    uint32_t value;
+    while (tokens.next(address) && tokens.next(name)) {
+        if (!parse_number(address, true, value) || !is_name(name)) {
+            return;
+        }
+        names.emplace_back(value, name.view());
+    }
+}
+
+// "START EQU 256" or "START: = 0100H". Source files mix equates with code,
+// so a bare pair, "START 0100" or "0100 START", is only taken when it is
+// the whole line, starts in the first column, writes its number as an
+// address and does not name an instruction or directive. "DB 0FFH" and
+// "  CPI 0DH" are code, not symbols.
+void parse_equates_line(LineTokens tokens, NameList& names) {
+    Token first, second, third;
+    uint32_t value;
+    if (!tokens.next(first) || !tokens.next(second)) {
+        return;
+    }
+    Token name = first;
+    strip_colon(name);
+    if (is_equate_keyword(second)) {
+        if (tokens.next(third) && is_name(name) && parse_number(third, false, value)) {
+            names.emplace_back(value, name.view());
+        }
+        return;
+    }
+    if (!tokens.starts_line(first) || tokens.next(third)) {
+        return;
+    }
+    if (is_name(name) && !is_reserved_word(name) && is_address_number(second, value)) {
+        names.emplace_back(value, name.view());
+    } else if (is_address_number(first, value) && is_name(second) && !is_reserved_word(second)) {
+        names.emplace_back(value, second.view());
+    }
+}
+
+// A linker map: pairs "START 0100 LOOP 0103" and "0100 START", several to
+// a line, and equates as above.
+void parse_map_line(LineTokens tokens, NameList& names) {
+    Token first, second, third;
+    uint32_t value;
+    while (tokens.next(first) && tokens.next(second)) {
+        Token name = first;
+        strip_colon(name);
+        if (is_equate_keyword(second)) {
+            if (tokens.next(third) && is_name(name) && parse_number(third, false, value)) {
+                names.emplace_back(value, name.view());
+            }
+            return;
+        }
+        if (is_name(name) && parse_number(second, true, value)) {
+            names.emplace_back(value, name.view());
+        } else if (looks_like_address(first) && parse_number(first, true, value) && is_name(second)) {
+            names.emplace_back(value, second.view());
+        } else {
+            return;
+        }
+    }
+}
+
+// Where a listing puts the address of a line: first on the line, or after
+// a line number. Only lines with code bytes tell the two apart, so the
+// layout is taken from the first of those.
+enum class ListingLayout { Unknown, Plain, LineNumbers };
+
+bool is_hex_word(Token token, size_t digits, uint32_t& value) {
+    return token.size() == digits && parse_number(token, true, value);
+}
+
+// "0100 C3 10 01 ..." is Plain, "  12 0100 C3 10 01 ..." has line numbers.
+// Unknown if the line has no code bytes.
+ListingLayout listing_layout_of(LineTokens tokens) {
+    Token first, second, third;
+    uint32_t value;
+    if (!tokens.next(first) || !tokens.next(second)) {
+        return ListingLayout::Unknown;
+    }
+    if (is_hex_word(first, 4, value) && is_hex_word(second, 2, value)) {
+        return ListingLayout::Plain;
+    }
+    if (parse_number(first, false, value) && is_hex_word(second, 4, value) && tokens.next(third) &&
+        is_hex_word(third, 2, value)) {
+        return ListingLayout::LineNumbers;
+    }
+    return ListingLayout::Unknown;
+}
+
+// "  12 0100 C3 10 01   START: JMP LOOP". On a line with code bytes the
+// address is the 4-digit hex word just before them. On a line with no code
+// ("  13 0103         TAIL:") it is the word after the line number, or the
+// only word before the label in a listing without line numbers. A label
+// line whose address cannot be told from a line number is skipped.
+void parse_listing_line(LineTokens tokens, ListingLayout layout, NameList& names) {
+    Token token;
+    std::optional<uint32_t> previous; // The previous word, if it was a 4-digit hex number
+    std::optional<uint32_t> address;  // Found from code bytes
+    std::optional<uint32_t> words[2]; // The first two words, if they were 4-digit hex numbers
+    size_t word_count = 0;            // Words before the label
+    uint32_t value;
+    while (tokens.next(token)) {
+        Token name = token;
+        if (strip_colon(name) && is_name(name)) {
+            if (!address && layout == ListingLayout::Plain && word_count == 1) {
+                address = words[0];
+            } else if (!address && layout == ListingLayout::LineNumbers && word_count == 2) {
+                address = words[1];
+            }
+            if (address) {
+                names.emplace_back(*address, name.view());
+            }
+            return;
+        }
+        if (!address && previous && is_hex_word(token, 2, value)) {
+            address = previous;
+        }
+        previous.reset();
+        if (is_hex_word(token, 4, value)) {
+            previous = value;
+        }
+        if (word_count < 2) {
+            words[word_count] = previous;
+        }
+        ++word_count;
+    }
+}
+
+// Calls 'visit' with the tokens of each line until it returns false.
+template <typename Visit>
+void for_each_line(const char* data, size_t size, Visit visit) {
+    const char* p = data;
+    const char* end = data + size;
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* line_end = newline ? newline : end;
+        if (!visit(LineTokens(p, line_end))) {
+            return;
+        }
+        p = line_end + 1;
+    }
+}
+
+} // namespace
+
+size_t import_symbols(const char* data, size_t size, SymbolFileFormat format, SymbolMap& symbols) {
+    ListingLayout layout = ListingLayout::Unknown;
+    if (format == SymbolFileFormat::Listing) {
+        for_each_line(data, size, [&](LineTokens tokens) {
+            layout = listing_layout_of(tokens);
+            return layout == ListingLayout::Unknown;
+        });
+    }
+
+    NameList names;
+    names.reserve(size / 16); // About one symbol per short line
+    for_each_line(data, size, [&](LineTokens tokens) {
+        switch (format) {
+            case SymbolFileFormat::CpmSym:
+                parse_cpm_sym_line(tokens, names);
+                break;
+            case SymbolFileFormat::Listing:
+                parse_listing_line(tokens, layout, names);
+                break;
+            case SymbolFileFormat::Map:
+                parse_map_line(tokens, names);
+                break;
+            case SymbolFileFormat::Auto:
+            case SymbolFileFormat::Equates:
+                parse_equates_line(tokens, names);
+                break;
+        }
+        return true;
+    });
+    symbols.add_all(names);
+    return names.size();
+}
+
+std::optional<size_t> import_symbol_file(const std::string& file_path, SymbolMap& symbols, SymbolFileFormat format) {
+    MappedFile file(file_path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << file_path << std::endl;
+        return std::nullopt;
+    }
+    if (format == SymbolFileFormat::Auto) {
+        format = symbol_format_for_path(file_path);
+    }
+    return import_symbols(file.data(), file.size(), format, symbols);
+}
+
+void export_symbols(std::ostream& out, const SymbolMap& symbols, SymbolFileFormat format) {
+    char line[320];
+    for (const SymbolMap::Symbol& symbol : symbols) {
+        char* end;
+        if (format == SymbolFileFormat::CpmSym) {
+            // "0100 START"
+            end = line + std::snprintf(line, sizeof(line), "%04X ", symbol.address);
+            end = symbols.format_name(end, line + sizeof(line) - 1, symbol);
+        } else {
+            // "START\tEQU\t0100H", with a leading 0 where the number starts with a letter.
+            end = symbols.format_name(line, line + sizeof(line) - 24, symbol);
+            char number[16];
+            std::snprintf(number, sizeof(number), "%04X", symbol.address);
+            end += std::snprintf(end, 24, "\tEQU\t%s%sH", std::isalpha(static_cast<unsigned char>(number[0])) ? "0" : "",
+                                 number);
+        }
+        *end++ = '\n';
+        out.write(line, end - line);
+    }
+}
+
+bool export_symbol_file(const std::string& file_path, const SymbolMap& symbols, SymbolFileFormat format) {
+    std::ofstream out(file_path);
+    if (!out.is_open()) {
+        std::cerr << "ERROR: Could not open " << file_path << " for writing." << std::endl;
+        return false;
+    }
+    if (format == SymbolFileFormat::Auto) {
+        format = symbol_format_for_path(file_path);
+    }
+    export_symbols(out, symbols, format);
+    return static_cast<bool>(out);
+}
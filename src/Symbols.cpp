@@ -1,81 +1,287 @@
 #include "Symbols.h"
-#include <set>
-#include <sstream>
-#include <iomanip>
+#include "OpcodeTable.h"
+#include "CodeFlow.h"
+#include <algorithm>
+#include <vector>
+#include <cstring>
 
 // Helper to safely read a 16-bit word from memory.
-static uint16_t mem_read_word(const MemoryMap& memory, uint32_t addr) {
-    auto it_lo = memory.find(addr);
-    auto it_hi = memory.find(addr + 1);
-    if (it_lo == memory.end() || it_hi == memory.end()) {
+static uint16_t mem_read_word(const MemoryImage& memory, uint32_t addr) {
+    auto lo = memory.read(addr);
+    auto hi = memory.read(addr + 1);
+    if (!lo || !hi) {
         return 0;
     }
-    return (it_hi->second << 8) | it_lo->second;
+    return (*hi << 8) | *lo;
 }
 
-SymbolMap generate_symbols(const MemoryMap& memory) {
+void SymbolMap::clear() {
+    symbols_.clear();
+    pool_.clear();
+    intern_.clear();
+    interned_ = 0;
+}
+
+std::vector<SymbolMap::Symbol>::iterator SymbolMap::position(uint32_t address) {
+    if (symbols_.empty() || symbols_.back().address < address) {
+        return symbols_.end();
+    }
+    return std::lower_bound(symbols_.begin(), symbols_.end(), address,
+                            [](const Symbol& symbol, uint32_t a) { return symbol.address < a; });
+}
+
+void SymbolMap::add_generated(uint32_t address) {
+    auto it = position(address);
+    if (it == symbols_.end() || it->address != address) {
+        symbols_.insert(it, {address, kGeneratedName});
+    }
+}
+
+void SymbolMap::add(uint32_t address, std::string_view name) {
+    uint32_t offset = intern(name);
+    auto it = position(address);
+    if (it != symbols_.end() && it->address == address) {
+        it->name = offset;
+    } else {
+        symbols_.insert(it, {address, offset});
+    }
+}
+
+void SymbolMap::merge_sorted(const std::vector<Symbol>& entries) {
+    std::vector<Symbol> merged;
+    merged.reserve(symbols_.size() + entries.size());
+    auto ours = symbols_.begin();
+    for (const Symbol& entry : entries) {
+        while (ours != symbols_.end() && ours->address < entry.address) {
+            merged.push_back(*ours++);
+        }
+        if (ours != symbols_.end() && ours->address == entry.address) {
+            merged.push_back(entry.name != kGeneratedName ? entry : *ours);
+            ++ours;
+        } else {
+            merged.push_back(entry);
+        }
+    }
+    merged.insert(merged.end(), ours, symbols_.end());
+    symbols_ = std::move(merged);
+}
+
+// Sorts by address, keeping entries with equal addresses in their order:
+// an LSD radix sort on 16-bit digits, which skips the upper pass when all
+// addresses are below 64K.
+static void sort_by_address(std::vector<SymbolMap::Symbol>& entries) {
+    std::vector<SymbolMap::Symbol> buffer(entries.size());
+    bool wide = std::any_of(entries.begin(), entries.end(),
+                            [](const SymbolMap::Symbol& entry) { return entry.address > 0xFFFF; });
+    for (int shift = 0; shift < (wide ? 32 : 16); shift += 16) {
+        std::vector<size_t> start(0x10001, 0);
+        for (const SymbolMap::Symbol& entry : entries) {
+            ++start[((entry.address >> shift) & 0xFFFF) + 1];
+        }
+        for (size_t i = 1; i < start.size(); ++i) {
+            start[i] += start[i - 1];
+        }
+        for (const SymbolMap::Symbol& entry : entries) {
+            buffer[start[(entry.address >> shift) & 0xFFFF]++] = entry;
+        }
+        entries.swap(buffer);
+    }
+}
+
+void SymbolMap::add_all(const std::vector<std::pair<uint32_t, std::string_view>>& names) {
+    std::vector<Symbol> entries;
+    entries.reserve(names.size());
+    reserve_names(names.size());
+    for (const auto& [address, name] : names) {
+        entries.push_back({address, intern(name)});
+    }
+    // Stable, so that of several names for one address the last one is kept.
+    sort_by_address(entries);
+    size_t kept = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (kept > 0 && entries[kept - 1].address == entries[i].address) {
+            entries[kept - 1] = entries[i];
+        } else {
+            entries[kept++] = entries[i];
+        }
+    }
+    entries.resize(kept);
+    merge_sorted(entries);
+}
+
+void SymbolMap::merge(const SymbolMap& other) {
+    if (&other == this) {
+        return;
+    }
+    std::vector<Symbol> entries(other.begin(), other.end());
+    for (Symbol& entry : entries) {
+        if (entry.name != kGeneratedName) {
+            entry.name = intern(other.pooled(entry.name));
+        }
+    }
+    merge_sorted(entries);
+}
+
+const SymbolMap::Symbol* SymbolMap::find(uint32_t address) const {
+    auto it = std::lower_bound(symbols_.begin(), symbols_.end(), address,
+                               [](const Symbol& symbol, uint32_t a) { return symbol.address < a; });
+    return it != symbols_.end() && it->address == address ? &*it : nullptr;
+}
+
+std::string_view SymbolMap::pooled(uint32_t offset) const {
+    return std::string_view(pool_.data() + offset);
+}
+
+// FNV-1a.
+static size_t hash_name(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+void SymbolMap::reserve_names(size_t count) {
+    // Keep the table at most half full.
+    if ((interned_ + count) * 2 <= intern_.size()) {
+        return;
+    }
+    size_t size = std::max<size_t>(64, intern_.size());
+    while (size < (interned_ + count) * 2) {
+        size *= 2;
+    }
+    std::vector<uint32_t> old = std::move(intern_);
+    intern_.assign(size, 0);
+    for (uint32_t slot : old) {
+        if (slot != 0) {
+            size_t i = hash_name(pooled(slot - 1)) & (intern_.size() - 1);
+            while (intern_[i] != 0) {
+                i = (i + 1) & (intern_.size() - 1);
+            }
+            intern_[i] = slot;
+        }
+    }
+}
+
+uint32_t SymbolMap::intern(std::string_view name) {
+    if ((interned_ + 1) * 2 > intern_.size()) {
+        reserve_names(std::max<size_t>(interned_, 1));
+    }
+
+    size_t i = hash_name(name) & (intern_.size() - 1);
+    while (intern_[i] != 0) {
+        if (pooled(intern_[i] - 1) == name) {
+            return intern_[i] - 1;
+        }
+        i = (i + 1) & (intern_.size() - 1);
+    }
+    uint32_t offset = static_cast<uint32_t>(pool_.size());
+    pool_.append(name.data(), name.size());
+    pool_.push_back('\0');
+    intern_[i] = offset + 1;
+    ++interned_;
+    return offset;
+}
+
+char* SymbolMap::format_name(char* first, char* last, const Symbol& symbol) const {
+    if (symbol.name != kGeneratedName) {
+        std::string_view name = pooled(symbol.name);
+        size_t length = std::min<size_t>(name.size(), last - first);
+        std::memcpy(first, name.data(), length);
+        return first + length;
+    }
+    // "L" + the address in upper-case hex, at least 4 digits.
+    char text[9] = {'L'};
+    int digits = 4;
+    while (digits < 8 && (symbol.address >> (digits * 4)) != 0) {
+        ++digits;
+    }
+    for (int i = 0; i < digits; ++i) {
+        text[digits - i] = "0123456789ABCDEF"[(symbol.address >> (i * 4)) & 0xF];
+    }
+    size_t length = std::min<size_t>(digits + 1, last - first);
+    std::memcpy(first, text, length);
+    return first + length;
+}
+
+std::string SymbolMap::name(const Symbol& symbol) const {
+    char text[16];
+    if (symbol.name != kGeneratedName) {
+        return std::string(pooled(symbol.name));
+    }
+    return std::string(text, format_name(text, text + sizeof(text), symbol));
+}
+
+// How many bytes are scanned for branch targets between progress reports.
+static constexpr size_t kProgressChunk = 1024 * 1024;
+
+SymbolMap generate_symbols(const MemoryImage& memory, const ProgressCallback& progress) {
     if (memory.empty()) {
         return {};
     }
+    const double total = double(memory.size());
+    size_t scanned = 0; // Bytes of earlier segments
 
-    std::set<uint32_t> label_addresses;
-    uint32_t pc = memory.begin()->first;
-    uint32_t end_addr = memory.rbegin()->first;
+    std::vector<uint32_t> label_addresses;
 
-    // First Pass: Scan for all JMP/CALL targets
-    while (pc <= end_addr) {
-        if (memory.find(pc) == memory.end()) {
-            pc++;
+    // First Pass: Scan for all JMP/CALL targets, one segment at a time so
+    // that gaps cost nothing. Sizes and branch targets come from the same
+    // table the disassemblers use; the 8080 and 8085 tables agree on both.
+    // 'pc' is the next address to scan. An instruction at the end of a
+    // segment may carry it past the start of the next one.
+    uint64_t pc = memory.min_address();
+    for (const MemorySegment& segment : memory.segments()) {
+        if (pc >= segment.end()) {
             continue;
         }
-        uint8_t opcode = memory.at(pc);
-        uint8_t size = 1;
-
-        // Check for 3-byte JMP and CALL opcodes
-        switch (opcode) {
-            case 0xC3: // JMP
-            case 0xC2: // JNZ
-            case 0xCA: // JZ
-            case 0xD2: // JNC
-            case 0xDA: // JC
-            case 0xE2: // JPO
-            case 0xEA: // JPE
-            case 0xF2: // JP
-            case 0xFA: // JM
-            case 0xCD: // CALL
-            case 0xC4: // CNZ
-            case 0xCC: // CZ
-            case 0xD4: // CNC
-            case 0xDC: // CC
-            case 0xE4: // CPO
-            case 0xEC: // CPE
-            case 0xF4: // CP
-            case 0xFC: // CM
-                label_addresses.insert(mem_read_word(memory, pc + 1));
-                size = 3;
-                break;
-            // All other opcodes have sizes of 1 or 2 bytes
-            case 0x06: case 0x0E: case 0x16: case 0x1E: case 0x26: 
-            case 0x2E: case 0x36: case 0x3E: case 0xC6: case 0xCE:
-            case 0xD6: case 0xDE: case 0xE6: case 0xEE: case 0xF6:
-            case 0xFE: case 0xD3: case 0xDB:
-                size = 2;
-                break;
-            case 0x01: case 0x11: case 0x21: case 0x31: case 0x22:
-            case 0x2A: case 0x32: case 0x3A:
-                size = 3;
-                break;
+        const uint8_t* data = segment.data;
+        size_t length = segment.length;
+        size_t offset = pc > segment.start ? size_t(pc - segment.start) : 0;
+
+        // Both operand bytes are inside the segment: read them straight from it.
+        size_t fast_end = length > 2 ? length - 2 : 0;
+        while (offset < fast_end) {
+            if (progress && !progress(float((scanned + offset) / total))) {
+                return {};
+            }
+            size_t chunk_end = std::min(fast_end, offset + kProgressChunk);
+            while (offset < chunk_end) {
+                const OpcodeInfo& info = opcodes_8080[data[offset]];
+                if (info.has_code_target()) {
+                    label_addresses.push_back(data[offset + 1] | (uint32_t(data[offset + 2]) << 8));
+                }
+                offset += info.size;
+            }
+        }
+        // The last two bytes: the operand may lie in the next segment or be missing.
+        while (offset < length) {
+            const OpcodeInfo& info = opcodes_8080[data[offset]];
+            if (info.has_code_target()) {
+                label_addresses.push_back(mem_read_word(memory, segment.start + static_cast<uint32_t>(offset) + 1));
+            }
+            offset += info.size;
         }
-        pc += size;
+        pc = segment.start + offset;
+        scanned += length;
     }
+    std::sort(label_addresses.begin(), label_addresses.end());
+    label_addresses.erase(std::unique(label_addresses.begin(), label_addresses.end()), label_addresses.end());
 
-    // Second Pass: Generate names for the found addresses
+    // Second Pass: one generated label per address. They are in order, so
+    // every add appends.
     SymbolMap symbols;
+    symbols.reserve(label_addresses.size());
     for (uint32_t addr : label_addresses) {
-        std::stringstream ss;
-        ss << "L" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << addr;
-        symbols[addr] = ss.str();
+        symbols.add_generated(addr);
+    }
+    return symbols;
+}
+
+SymbolMap generate_symbols(const CodeMap& code) {
+    SymbolMap symbols;
+    symbols.reserve(code.targets().size());
+    for (uint32_t addr : code.targets()) {
+        symbols.add_generated(addr);
     }
-    
     return symbols;
 }
\ No newline at end of file
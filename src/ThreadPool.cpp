@@ -0,0 +1,157 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+unsigned resolve_thread_count(unsigned requested) {
+    if (requested != 0) {
+        return requested;
+    }
+    unsigned hardware = std::thread::hardware_concurrency();
+    return hardware != 0 ? hardware : 1;
+}
+
+ThreadPool::ThreadPool(unsigned thread_count) {
+    unsigned count = resolve_thread_count(thread_count);
+    workers_.reserve(count);
+    for (unsigned i = 0; i < count; ++i) {
+        workers_.emplace_back([this]() { worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+}
+
+void ThreadPool::worker_loop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+            if (jobs_.empty()) {
+                return; // Stopping and nothing left to do.
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        job();
+    }
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& task) {
+    std::vector<std::future<void>> pending;
+    pending.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        pending.push_back(submit([&task, i]() { task(i); }));
+    }
+    // Wait for everything before rethrowing, so no job outlives 'task'.
+    for (auto& job : pending) {
+        job.wait();
+    }
+    for (auto& job : pending) {
+        job.get();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+namespace {
+
+// One worker's share of the indices. The owner pops from the front and
+// thieves take from the back, so they rarely contend for the same items.
+struct StealingDeque {
+    std::mutex mutex;
+    std::deque<size_t> items;
+
+    bool pop_front(size_t& index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (items.empty()) return false;
+        index = items.front();
+        items.pop_front();
+        return true;
+    }
+
+    bool steal_back(size_t& index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (items.empty()) return false;
+        index = items.back();
+        items.pop_back();
+        return true;
+    }
+};
+
+} // namespace
+
+void work_stealing_for(size_t count, unsigned thread_count, const std::function<void(size_t, unsigned)>& task) {
+    unsigned workers = static_cast<unsigned>(std::min<size_t>(resolve_thread_count(thread_count), count));
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i, 0);
+        }
+        return;
+    }
+
+    // Deal the indices round robin, so each deque holds a spread of the input.
+    std::vector<StealingDeque> deques(workers);
+    for (size_t i = 0; i < count; ++i) {
+        deques[i % workers].items.push_back(i);
+    }
+
+    std::atomic<bool> failed{false};
+    std::exception_ptr first_error;
+    std::mutex error_mutex;
+
+    auto run_worker = [&](unsigned self) {
+        size_t index;
+        while (!failed.load()) {
+            bool found = deques[self].pop_front(index);
+            for (unsigned k = 1; !found && k < workers; ++k) {
+                found = deques[(self + k) % workers].steal_back(index);
+            }
+            if (!found) {
+                return; // Nothing left anywhere; nobody adds work later.
+            }
+            try {
+                task(index, self);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!first_error) {
+                    first_error = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (unsigned w = 1; w < workers; ++w) {
+        threads.emplace_back(run_worker, w);
+    }
+    run_worker(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (first_error) {
+        std::rethrow_exception(first_error);
+    }
+}
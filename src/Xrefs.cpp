@@ -0,0 +1,148 @@
+#include "Xrefs.h"
+#include <array>
+#include <cstdio>
+
+namespace {
+
+constexpr uint8_t kNoReference = 0xFF;
+
+// The kind of reference each opcode makes, or kNoReference.
+std::array<uint8_t, 256> reference_kinds(const OpcodeTable& opcodes) {
+    std::array<uint8_t, 256> kinds;
+    for (int opcode = 0; opcode < 256; ++opcode) {
+        const OpcodeInfo& info = opcodes[opcode];
+        XrefKind kind;
+        switch (info.flow) {
+            case FlowType::Call:
+            case FlowType::CondCall:
+            case FlowType::Restart:
+                kind = XrefKind::Call;
+                break;
+            case FlowType::Jump:
+            case FlowType::CondJump:
+                kind = XrefKind::Jump;
+                break;
+            default:
+                switch (info.mnemonic) {
+                    case Mnemonic::LDA:
+                    case Mnemonic::LHLD:
+                        kind = XrefKind::Read;
+                        break;
+                    case Mnemonic::STA:
+                    case Mnemonic::SHLD:
+                        kind = XrefKind::Write;
+                        break;
+                    case Mnemonic::LXI:
+                        kind = XrefKind::Address;
+                        break;
+                    default:
+                        kinds[opcode] = kNoReference;
+                        continue;
+                }
+        }
+        kinds[opcode] = static_cast<uint8_t>(kind);
+    }
+    return kinds;
+}
+
+// The address 'instr' refers to, if it is an instruction that refers to one
+// and all of its bytes are in the image.
+bool reference_target(const DisassembledInstruction& instr, const std::array<uint8_t, 256>& kinds,
+                      const MemoryImage& memory, uint32_t& target) {
+    if (instr.flags != 0 || kinds[instr.opcode] == kNoReference) {
+        return false;
+    }
+    if (instr.size == 1) {
+        target = instr.opcode & 0x38; // RST n calls n * 8
+        return true;
+    }
+    // The sweep reads operand bytes missing from the image as 0, so each
+    // one has to be there for the target to be real.
+    for (uint32_t i = 1; i < instr.size; ++i) {
+        if (!memory.contains(instr.address + i)) {
+            return false;
+        }
+    }
+    target = instr.operand & 0xFFFF;
+    return true;
+}
+
+} // namespace
+
+XrefIndex build_xrefs(const MemoryImage& memory, const std::vector<DisassembledInstruction>& disassembly, CpuType cpu) {
+    std::array<uint8_t, 256> kinds = reference_kinds(opcode_table(cpu));
+    XrefIndex index;
+
+    // First pass: count the references to each address, shifted by one so
+    // the running sum below turns the counts into row starts.
+    std::vector<uint32_t> offsets(XrefIndex::kAddressCount + 1, 0);
+    uint32_t target;
+    for (const DisassembledInstruction& instr : disassembly) {
+        if (reference_target(instr, kinds, memory, target)) {
+            ++offsets[target + 1];
+        }
+    }
+    for (uint32_t address = 0; address < XrefIndex::kAddressCount; ++address) {
+        offsets[address + 1] += offsets[address];
+    }
+    if (offsets.back() == 0) {
+        return index;
+    }
+
+    // Second pass: place each reference in its row. The listing is in
+    // address order, so every row comes out sorted by source.
+    index.refs_.resize(offsets.back());
+    std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+    for (const DisassembledInstruction& instr : disassembly) {
+        if (reference_target(instr, kinds, memory, target)) {
+            index.refs_[next[target]++] = {instr.address, static_cast<XrefKind>(kinds[instr.opcode])};
+        }
+    }
+    index.offsets_ = std::move(offsets);
+    return index;
+}
+
+const char* xref_kind_name(XrefKind kind) {
+    switch (kind) {
+        case XrefKind::Call:  return "CALL";
+        case XrefKind::Jump:  return "JMP";
+        case XrefKind::Read:  return "READ";
+        case XrefKind::Write: return "WRITE";
+        default:              return "LXI";
+    }
+}
+
+void write_xref_listing(std::ostream& out, const XrefIndex& xrefs, const SymbolMap& symbols) {
+    static const char kind_letters[] = {'C', 'J', 'R', 'W', 'A'};
+    constexpr int kRefsPerLine = 8;
+    out << "; Cross reference. C = CALL/RST, J = JMP, R = read, W = write, A = LXI.\n";
+    char line[512];
+    for (uint32_t address = 0; address < XrefIndex::kAddressCount; ++address) {
+        XrefList refs = xrefs.refs_to(address);
+        if (refs.empty()) {
+            continue;
+        }
+        // "0110  L0110         C0103 J0120 ..."
+        char* end = line + std::snprintf(line, sizeof(line), "%04X  ", address);
+        char* name_start = end;
+        if (const SymbolMap::Symbol* symbol = symbols.find(address)) {
+            end = symbols.format_name(end, line + 256, *symbol);
+        }
+        while (end < name_start + 14) {
+            *end++ = ' ';
+        }
+        int on_line = 0;
+        for (const Xref& ref : refs) {
+            if (on_line == kRefsPerLine) {
+                *end++ = '\n';
+                out.write(line, end - line);
+                end = line + std::snprintf(line, sizeof(line), "%20s", "");
+                on_line = 0;
+            }
+            end += std::snprintf(end, 16, " %c%04X", kind_letters[static_cast<int>(ref.kind)], ref.from);
+            ++on_line;
+        }
+        *end++ = '\n';
+        out.write(line, end - line);
+    }
+}
@@ -0,0 +1,591 @@
+// Headless batch front end: no SDL and no ImGui. Processes many HEX/BIN
+// files concurrently and writes a listing, a flat binary and a report for
+// each, followed by an aggregate throughput summary.
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "HexParser.h"
+#include "HexDecode.h"
+#include "FillScan.h"
+#include "Memory.h"
+#include "MemoryConflicts.h"
+#include "Symbols.h"
+#include "SymbolFile.h"
+#include "Disassembly.h"
+#include "CodeFlow.h"
+#include "Xrefs.h"
+#include "HexWriter.h"
+#include "BinaryWriter.h"
+#include "ThreadPool.h"
+
+namespace fs = std::filesystem;
+
+struct BatchOptions {
+    std::string output_dir = "batch_out";
+    unsigned thread_count = 0;          // 0 = all hardware threads
+    CpuType cpu = CpuType::I8080;
+    CodeFlowOptions flow;               // --flow, --entry, --no-vectors
+    SymbolMap imported_symbols;         // --symbols, merged into every file's labels
+    bool write_listing = true;
+    bool write_binary = true;
+    bool write_report = true;
+    bool write_hex = false;
+    bool write_symbols = false;
+    bool write_xrefs = false;
+    uint8_t hex_record_size = 16;
+    uint8_t fill = 0xFF;                // Gap fill for flat binaries
+    uint64_t max_binary_size = 64ull << 20; // Skip flat binaries spanning more than this
+    bool quiet = false;
+    std::string merge_name;             // --merge: all inputs go into one image with this name
+    std::optional<BinaryLoadOptions> binary_window; // --base/--offset: load raw binaries as given, fill and all
+};
+
+// What processing one input produced; also the source of its report.
+struct FileResult {
+    bool ok = false;
+    std::string error;
+    FileType type = FileType::Unknown;
+    uint64_t input_bytes = 0;
+    size_t records = 0;
+    size_t conflicts = 0;
+    size_t differing_conflicts = 0;
+    size_t cross_input_conflicts = 0;   // --merge: overlaps between two different inputs
+    size_t merged_inputs = 0;           // --merge: how many files went into the image
+    std::optional<RomFillInfo> rom_fill; // Raw binaries loaded as ROM dumps (not with --base/--offset)
+    size_t image_bytes = 0;
+    size_t segments = 0;
+    uint32_t min_address = 0;
+    uint32_t max_address = 0;
+    size_t symbols = 0;
+    size_t instructions = 0;
+    size_t code_bytes = 0;              // Follow-flow mode only
+    size_t references = 0;
+    std::string binary_note;
+    double seconds = 0;
+};
+
+static void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <file|directory|@list>...\n"
+              << "  -o, --output DIR    Output directory (default: batch_out)\n"
+              << "  -j, --jobs N        Worker threads (default: all hardware threads)\n"
+              << "  --cpu 8080|8085     Disassembler to use (default: 8080)\n"
+              << "  --flow              Follow the code from its entry points instead of sweeping every byte\n"
+              << "  --entry ADDR        Extra hex entry point for --flow (repeatable)\n"
+              << "  --no-vectors        With --flow, do not start at the RST/interrupt vectors\n"
+              << "  --fill XX           Hex byte used for gaps in flat binaries (default: FF)\n"
+              << "  --base ADDR         Load raw binaries at this hex address, without skipping leading fill\n"
+              << "  --offset N          Start raw binaries N (hex) bytes into the file, without skipping fill\n"
+              << "  --max-bin MB        Skip flat binaries larger than this (default: 64)\n"
+              << "  --no-asm            Do not write .asm listings\n"
+              << "  --no-bin            Do not write flat .bin images\n"
+              << "  --no-report         Do not write per-file reports; HEX files are then streamed\n"
+              << "                      straight into the image, without keeping their records\n"
+              << "  --hex [N]           Also re-emit each image as Intel HEX, N bytes per record (default: 16)\n"
+              << "  --symbols FILE      Import labels from a .sym/.map/.lst file (repeatable)\n"
+              << "  --write-sym         Also write each file's labels as a CP/M .sym file\n"
+              << "  --xref              Also write a cross reference table (.xrf) for each file\n"
+              << "  --merge NAME        Merge all inputs (Intel HEX) into one image, written as NAME.*;\n"
+              << "                      later files win where they overlap earlier ones\n"
+              << "  -q, --quiet         Only print the summary\n"
+              << "Directories are searched recursively; @list reads one path per line.\n";
+}
+
+// Expands directories and @list files into a flat list of input files.
+static void collect_inputs(const std::string& arg, std::vector<std::string>& inputs) {
+    if (arg.size() > 1 && arg[0] == '@') {
+        std::ifstream list(arg.substr(1));
+        std::string line;
+        while (std::getline(list, line)) {
+            while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+                line.pop_back();
+            }
+            if (!line.empty()) {
+                collect_inputs(line, inputs);
+            }
+        }
+        return;
+    }
+    std::error_code ec;
+    if (fs::is_directory(arg, ec)) {
+        for (const auto& entry : fs::recursive_directory_iterator(arg, ec)) {
+            if (entry.is_regular_file(ec)) {
+                inputs.push_back(entry.path().string());
+            }
+        }
+        return;
+    }
+    inputs.push_back(arg);
+}
+
+static const char* file_type_name(FileType type) {
+    switch (type) {
+        case FileType::IntelHex:  return "Intel HEX";
+        case FileType::RawBinary: return "raw binary";
+        default:                  return "unknown";
+    }
+}
+
+static void write_report(const std::string& path, const std::string& input, const FileResult& result) {
+    std::ofstream out(path);
+    char line[128];
+    out << "input:        " << input << "\n";
+    out << "status:       " << (result.ok ? "ok" : "error: " + result.error) << "\n";
+    out << "type:         " << file_type_name(result.type) << "\n";
+    out << "input bytes:  " << result.input_bytes << "\n";
+    if (!result.ok) {
+        return;
+    }
+    if (result.type == FileType::IntelHex) {
+        out << "records:      " << result.records << "\n";
+        out << "overlaps:     " << result.conflicts << " (" << result.differing_conflicts << " with different data";
+        if (result.merged_inputs > 0) {
+            out << ", " << result.cross_input_conflicts << " between inputs";
+        }
+        out << ")\n";
+    } else if (result.rom_fill) {
+        out << "fill:         " << result.rom_fill->leading << " leading bytes skipped, " << result.rom_fill->trailing
+            << " trailing bytes\n";
+    }
+    out << "image bytes:  " << result.image_bytes << "\n";
+    out << "segments:     " << result.segments << "\n";
+    if (result.image_bytes > 0) {
+        std::snprintf(line, sizeof(line), "0x%08X - 0x%08X", result.min_address, result.max_address);
+        out << "address span: " << line << "\n";
+    }
+    out << "symbols:      " << result.symbols << "\n";
+    out << "instructions: " << result.instructions << "\n";
+    out << "references:   " << result.references << "\n";
+    if (result.code_bytes > 0) {
+        out << "code bytes:   " << result.code_bytes << "\n";
+    }
+    if (!result.binary_note.empty()) {
+        out << "binary:       " << result.binary_note << "\n";
+    }
+    std::snprintf(line, sizeof(line), "%.3f", result.seconds);
+    out << "seconds:      " << line << "\n";
+}
+
+// Analyses and disassembles a loaded image and writes its outputs, filling
+// in the rest of 'result'.
+static void analyze_and_write(const MemoryImage& memory, std::optional<uint32_t> start_address,
+                              const std::string& output_stem, const BatchOptions& options, FileResult& result) {
+    result.ok = true;
+    result.image_bytes = memory.size();
+    result.segments = memory.segment_count();
+    if (!memory.empty()) {
+        result.min_address = memory.min_address();
+        result.max_address = memory.max_address();
+    }
+
+    std::unique_ptr<CpuDisassembler> disassembler = make_disassembler(options.cpu);
+    SymbolMap symbols;
+    std::vector<DisassembledInstruction> disassembly;
+    if (options.flow.mode == DisassemblyMode::FollowFlow) {
+        std::vector<uint32_t> entry_points =
+            collect_entry_points(memory, options.cpu, options.flow, start_address);
+        CodeMap code = analyze_code_flow(memory, options.cpu, entry_points);
+        result.code_bytes = code.code_bytes();
+        symbols = generate_symbols(code);
+        disassembly = disassemble_code_map(memory, *disassembler, code);
+    } else {
+        symbols = generate_symbols(memory);
+        disassembly = disassemble_image(memory, *disassembler);
+    }
+    if (!options.imported_symbols.empty()) {
+        symbols.merge(options.imported_symbols);
+    }
+    result.symbols = symbols.size();
+    result.instructions = disassembly.size();
+    XrefIndex xrefs = build_xrefs(memory, disassembly, options.cpu);
+    result.references = xrefs.size();
+
+    if (options.write_listing) {
+        std::ofstream listing(output_stem + ".asm");
+        write_disassembly_listing(listing, disassembly, options.cpu, symbols);
+        if (!listing) {
+            result.ok = false;
+            result.error = "could not write " + output_stem + ".asm";
+        }
+    }
+    if (options.write_hex) {
+        HexWriteOptions hex_options;
+        hex_options.record_size = options.hex_record_size;
+        hex_options.start_address = start_address; // Keep the input's 0x03/0x05 record
+        if (!write_hex_file(output_stem + ".hex", memory, hex_options)) {
+            result.ok = false;
+            result.error = "could not write " + output_stem + ".hex";
+        }
+    }
+    if (options.write_symbols && !export_symbol_file(output_stem + ".sym", symbols, SymbolFileFormat::CpmSym)) {
+        result.ok = false;
+        result.error = "could not write " + output_stem + ".sym";
+    }
+    if (options.write_xrefs) {
+        std::ofstream xref_listing(output_stem + ".xrf");
+        write_xref_listing(xref_listing, xrefs, symbols);
+        if (!xref_listing) {
+            result.ok = false;
+            result.error = "could not write " + output_stem + ".xrf";
+        }
+    }
+    if (options.write_binary && !memory.empty()) {
+        BinaryExportOptions binary_options;
+        binary_options.fill = options.fill;
+        uint64_t span = uint64_t(result.max_address) - result.min_address + 1;
+        if (span > options.max_binary_size) {
+            result.binary_note = "skipped, spans " + std::to_string(span) + " bytes";
+        } else if (!export_binary_file(output_stem + ".bin", memory, binary_options)) {
+            result.ok = false;
+            result.error = "could not write " + output_stem + ".bin";
+        }
+    }
+}
+
+// Loads, analyses and disassembles one file and writes its outputs. Runs on
+// a batch worker; the inner steps stay serial since the batch itself is the
+// parallelism.
+static FileResult process_file(const std::string& input, const std::string& output_stem, const BatchOptions& options) {
+    auto started = std::chrono::steady_clock::now();
+    FileResult result;
+    std::error_code ec;
+    result.input_bytes = fs::file_size(input, ec);
+    result.type = detect_file_type(input);
+
+    MemoryImage memory;
+    std::optional<uint32_t> start_address; // From a 0x03/0x05 record
+    if (result.type == FileType::IntelHex && !options.write_report) {
+        // Without a report nothing needs the records themselves (they are only
+        // counted and checked for overlaps there), so the text is streamed
+        // straight into the image and never held as a HexRecordSet.
+        HexLoadInfo info;
+        memory = load_hex_memory_map(input, &info);
+        result.records = info.records;
+        start_address = info.start_address;
+        if (!info.opened) {
+            result.error = "could not open or empty file";
+        }
+    } else if (result.type == FileType::IntelHex) {
+        HexRecordSet records = load_hex_record_set(input, 1);
+        result.records = records.size();
+        start_address = find_start_address(records);
+        memory = build_memory_map(records);
+        std::vector<MemoryConflict> conflicts = find_memory_conflicts(records);
+        result.conflicts = conflicts.size();
+        result.differing_conflicts = std::count_if(conflicts.begin(), conflicts.end(),
+                                                   [](const MemoryConflict& c) { return !c.identical; });
+    } else if (result.type == FileType::RawBinary && options.binary_window) {
+        memory = load_binary_image(input, *options.binary_window);
+        if (memory.empty()) {
+            result.error = "nothing to load past the offset";
+        }
+    } else if (result.type == FileType::RawBinary) {
+        result.rom_fill.emplace();
+        memory = load_rom_image(input, 0x00, &*result.rom_fill);
+    } else {
+        result.error = "could not open or empty file";
+    }
+
+    if (result.error.empty()) {
+        analyze_and_write(memory, start_address, output_stem, options, result);
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (options.write_report) {
+        write_report(output_stem + ".txt", input, result);
+    }
+    return result;
+}
+
+// Merges HEX files into one image in the given order, so a later file wins
+// where two write the same addresses (e.g. an application over the
+// bootloader it was built on), and writes the outputs for that image.
+// Overlaps are looked for across all the files, not just within each.
+static FileResult process_merge(const std::vector<std::string>& inputs, const std::string& output_stem,
+                                const BatchOptions& options) {
+    auto started = std::chrono::steady_clock::now();
+    FileResult result;
+    result.type = FileType::IntelHex;
+    result.merged_inputs = inputs.size();
+
+    std::vector<HexRecordSet> record_sets;
+    record_sets.reserve(inputs.size());
+    MemoryImage memory;
+    std::optional<uint32_t> start_address; // The last file's 0x03/0x05 record
+    for (const std::string& input : inputs) {
+        std::error_code ec;
+        result.input_bytes += fs::file_size(input, ec);
+        if (detect_file_type(input) != FileType::IntelHex) {
+            result.error = input + " is not an Intel HEX file";
+            break;
+        }
+        record_sets.push_back(load_hex_record_set(input, options.thread_count));
+        const HexRecordSet& records = record_sets.back();
+        result.records += records.size();
+        if (std::optional<uint32_t> start = find_start_address(records)) {
+            start_address = start;
+        }
+        memory.overlay(build_memory_map_parallel(records, options.thread_count));
+    }
+
+    if (result.error.empty()) {
+        memory.compact();
+        std::vector<const HexRecordSet*> sets;
+        for (const HexRecordSet& records : record_sets) {
+            sets.push_back(&records);
+        }
+        std::vector<MemoryConflict> conflicts = find_memory_conflicts(sets);
+        result.conflicts = conflicts.size();
+        result.differing_conflicts = std::count_if(conflicts.begin(), conflicts.end(),
+                                                   [](const MemoryConflict& c) { return !c.identical; });
+        result.cross_input_conflicts = std::count_if(conflicts.begin(), conflicts.end(), [](const MemoryConflict& c) {
+            return c.earlier.input != c.later.input;
+        });
+        analyze_and_write(memory, start_address, output_stem, options, result);
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (options.write_report) {
+        std::string names;
+        for (const std::string& input : inputs) {
+            names += (names.empty() ? "" : ", ") + input;
+        }
+        write_report(output_stem + ".txt", names, result);
+    }
+    return result;
+}
+
+// Output names come from the input file names; a name already taken gets
+// the first free "_N" suffix. Names are compared without case, since two
+// names differing only in case are the same file on Windows.
+static std::vector<std::string> make_output_stems(const std::vector<std::string>& inputs, const std::string& output_dir) {
+    auto lower = [](std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return text;
+    };
+    std::set<std::string> seen; // Every name handed out so far, in lower case
+    std::vector<std::string> stems;
+    stems.reserve(inputs.size());
+    for (const std::string& input : inputs) {
+        std::string base = fs::path(input).stem().string();
+        std::string name = base;
+        for (int suffix = 1; !seen.insert(lower(name)).second; ++suffix) {
+            name = base + "_" + std::to_string(suffix);
+        }
+        stems.push_back((fs::path(output_dir) / name).string());
+    }
+    return stems;
+}
+
+// Reads an option's number: the whole of 'text' in 'base' (hex may start
+// with 0x), within [min, max]. Anything else ends the program with status 2.
+static uint64_t parse_option_number(const std::string& option, const std::string& text, int base, uint64_t min,
+                                    uint64_t max) {
+    const char* first = text.data();
+    const char* last = text.data() + text.size();
+    if (base == 16 && text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        first += 2;
+    }
+    uint64_t value = 0;
+    auto [end, error] = std::from_chars(first, last, value, base);
+    if (first == last || error != std::errc() || end != last || value < min || value > max) {
+        char range[64];
+        std::snprintf(range, sizeof(range), base == 16 ? "hex %llX..%llX" : "%llu..%llu",
+                      static_cast<unsigned long long>(min), static_cast<unsigned long long>(max));
+        std::cerr << "Invalid value for " << option << ": " << text << " (expected " << range << ")\n";
+        std::exit(2);
+    }
+    return value;
+}
+
+int main(int argc, char** argv) {
+    BatchOptions options;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next_value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "-o" || arg == "--output") {
+            options.output_dir = next_value();
+        } else if (arg == "-j" || arg == "--jobs") {
+            options.thread_count = static_cast<unsigned>(parse_option_number(arg, next_value(), 10, 0, 4096));
+        } else if (arg == "--cpu") {
+            std::string cpu = next_value();
+            if (cpu == "8080") {
+                options.cpu = CpuType::I8080;
+            } else if (cpu == "8085") {
+                options.cpu = CpuType::I8085;
+            } else {
+                std::cerr << "Unknown CPU: " << cpu << "\n";
+                return 2;
+            }
+        } else if (arg == "--flow") {
+            options.flow.mode = DisassemblyMode::FollowFlow;
+        } else if (arg == "--entry") {
+            options.flow.entry_points.push_back(
+                static_cast<uint32_t>(parse_option_number(arg, next_value(), 16, 0, 0xFFFFFFFF)));
+        } else if (arg == "--no-vectors") {
+            options.flow.interrupt_vectors = false;
+        } else if (arg == "--fill") {
+            options.fill = static_cast<uint8_t>(parse_option_number(arg, next_value(), 16, 0, 0xFF));
+        } else if (arg == "--base" || arg == "--offset") {
+            if (!options.binary_window) {
+                options.binary_window.emplace();
+            }
+            if (arg == "--base") {
+                options.binary_window->base_address =
+                    static_cast<uint32_t>(parse_option_number(arg, next_value(), 16, 0, 0xFFFFFFFF));
+            } else {
+                options.binary_window->file_offset = parse_option_number(arg, next_value(), 16, 0, UINT64_MAX);
+            }
+        } else if (arg == "--max-bin") {
+            options.max_binary_size = parse_option_number(arg, next_value(), 10, 0, UINT64_MAX >> 20) << 20;
+        } else if (arg == "--no-asm") {
+            options.write_listing = false;
+        } else if (arg == "--no-bin") {
+            options.write_binary = false;
+        } else if (arg == "--no-report") {
+            options.write_report = false;
+        } else if (arg == "--hex") {
+            options.write_hex = true;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                options.hex_record_size = static_cast<uint8_t>(parse_option_number(arg, argv[++i], 10, 1, 255));
+            }
+        } else if (arg == "--symbols") {
+            std::string path = next_value();
+            if (!import_symbol_file(path, options.imported_symbols)) {
+                return 1;
+            }
+        } else if (arg == "--write-sym") {
+            options.write_symbols = true;
+        } else if (arg == "--xref") {
+            options.write_xrefs = true;
+        } else if (arg == "--merge") {
+            options.merge_name = next_value();
+        } else if (arg == "-q" || arg == "--quiet") {
+            options.quiet = true;
+        } else if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << "\n";
+            print_usage(argv[0]);
+            return 2;
+        } else {
+            collect_inputs(arg, inputs);
+        }
+    }
+    if (inputs.empty()) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    std::error_code ec;
+    fs::create_directories(options.output_dir, ec);
+    if (ec) {
+        std::cerr << "ERROR: Could not create output directory " << options.output_dir << ": " << ec.message() << "\n";
+        return 1;
+    }
+
+    if (!options.merge_name.empty()) {
+        // One job for all the inputs; the loading and building inside it
+        // use the thread pool instead.
+        std::string stem = (fs::path(options.output_dir) / options.merge_name).string();
+        FileResult result;
+        try {
+            result = process_merge(inputs, stem, options);
+        } catch (const std::exception& e) {
+            result.error = e.what();
+        }
+        if (!result.ok) {
+            std::printf("FAIL  %s: %s\n", stem.c_str(), result.error.c_str());
+            return 1;
+        }
+        std::printf("Merged:       %zu files into %s (%.3f s)\n", inputs.size(), stem.c_str(), result.seconds);
+        std::printf("Image:        %zu bytes in %zu segments\n", result.image_bytes, result.segments);
+        std::printf("Overlaps:     %zu (%zu with different data, %zu between files)\n", result.conflicts,
+                    result.differing_conflicts, result.cross_input_conflicts);
+        return 0;
+    }
+
+    // Largest files first, so the long jobs start early and the small ones
+    // fill in the gaps at the end.
+    std::vector<uint64_t> sizes(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        sizes[i] = fs::file_size(inputs[i], ec);
+        if (ec) sizes[i] = 0;
+    }
+    std::vector<size_t> order(inputs.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    std::vector<std::string> stems = make_output_stems(inputs, options.output_dir);
+    std::vector<FileResult> results(inputs.size());
+    std::mutex print_mutex;
+    size_t finished = 0;
+    unsigned workers = static_cast<unsigned>(std::min<size_t>(resolve_thread_count(options.thread_count), inputs.size()));
+
+    auto started = std::chrono::steady_clock::now();
+    work_stealing_for(order.size(), workers, [&](size_t slot, unsigned) {
+        size_t index = order[slot];
+        try {
+            results[index] = process_file(inputs[index], stems[index], options);
+        } catch (const std::exception& e) {
+            results[index].error = e.what();
+        }
+        std::lock_guard<std::mutex> lock(print_mutex);
+        ++finished;
+        const FileResult& result = results[index];
+        if (!options.quiet || !result.ok) {
+            std::printf("[%zu/%zu] %-5s %s (%.3f s)%s%s\n", finished, inputs.size(), result.ok ? "ok" : "FAIL",
+                        inputs[index].c_str(), result.seconds, result.ok ? "" : ": ", result.error.c_str());
+        }
+    });
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    size_t ok_count = 0;
+    uint64_t input_bytes = 0;
+    uint64_t image_bytes = 0;
+    size_t instructions = 0;
+    double busy_seconds = 0;
+    for (const FileResult& result : results) {
+        ok_count += result.ok;
+        input_bytes += result.input_bytes;
+        image_bytes += result.image_bytes;
+        instructions += result.instructions;
+        busy_seconds += result.seconds;
+    }
+
+    double mib = input_bytes / (1024.0 * 1024.0);
+    std::printf("\n--- Batch summary ---\n");
+    std::printf("Files:        %zu ok, %zu failed, %zu total\n", ok_count, inputs.size() - ok_count, inputs.size());
+    std::printf("Workers:      %u\n", workers);
+    std::printf("Kernels:      hex decode %s, fill scan %s\n", hex_decoder_name(), fill_scan_kernel_name());
+    std::printf("Input:        %.2f MiB (%llu bytes in images)\n", mib, static_cast<unsigned long long>(image_bytes));
+    std::printf("Instructions: %zu\n", instructions);
+    std::printf("Wall time:    %.3f s (%.3f s of per-file work)\n", elapsed, busy_seconds);
+    if (elapsed > 0) {
+        std::printf("Throughput:   %.1f files/s, %.2f MiB/s\n", inputs.size() / elapsed, mib / elapsed);
+    }
+    std::printf("Outputs in:   %s\n", options.output_dir.c_str());
+    return ok_count == inputs.size() ? 0 : 1;
+}
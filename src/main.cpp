@@ -3,6 +3,10 @@
 #include <vector>
 #include <sstream>
 #include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
 
 // Vendor Libraries
 #include "SDL2/SDL.h"
@@ -18,56 +22,47 @@
 #include "HexParser.h"
 #include "Memory.h"
 #include "CpuDisassembler.h"
-#include "i8085.h"
 #include "Symbols.h"
-
-// Defining a enum filetype to open
-enum class FileType {
-    Unknown,
-    IntelHex,
-    RawBinary
-};
-
-// This function is to check if a character is valid in an Intel HEX file
-bool is_valid_hex_char(char c) {
-    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || ( c >= 'a' && c <= 'f') || c == ':' || isspace(c);
-}
-
-FileType detect_file_type(const std::string& file_path) {
-    std::ifstream file(file_path, std::ios::binary);
-    if (!file.is_open()) {
-        return FileType::Unknown; // Of handle the error appropriately
-    }
-
-    // Read the first 512 bytes for analysis
-    std::vector<char> buffer(512, 0);
-    file.read(buffer.data(), buffer.size());
-
-    if (file.gcount() == 0) {
-        return FileType::Unknown; // Empty or unreadable file
+#include "SymbolFile.h"
+#include "Xrefs.h"
+#include "MemoryConflicts.h"
+#include "LoadPipeline.h"
+#include "HexWriter.h"
+#include "BinaryWriter.h"
+
+// Rows of the disassembly view: one per instruction plus one per label, so
+// the view can be clipped to what is on screen. Label rows have the top bit set.
+static constexpr uint32_t kLabelRow = 0x80000000;
+
+static std::vector<uint32_t> build_disassembly_rows(const std::vector<DisassembledInstruction>& disassembly,
+                                                    const SymbolMap& symbols) {
+    std::vector<uint32_t> rows;
+    rows.reserve(disassembly.size());
+    for (uint32_t i = 0; i < disassembly.size(); ++i) {
+        if (symbols.contains(disassembly[i].address)) {
+            rows.push_back(i | kLabelRow);
+        }
+        rows.push_back(i);
     }
+    return rows;
+}
 
-    // *** Heuristic for Intel HEX ***
-    // 1. Must start with a ':'
-    // 2. All characters should be valid hex/control characters
-    if (buffer[0] == ':') {
-        bool is_plausible_hex = true;
-        for (std::streamsize i = 0; i < file.gcount(); ++i) {
-            if (!is_valid_hex_char(buffer[i])) {
-                is_plausible_hex = false;
-                break;
-            }
-        }
-        if (is_plausible_hex) {
-            return FileType::IntelHex;
+// Reads hex addresses separated by spaces or commas, e.g. "0100, 8000".
+static std::vector<uint32_t> parse_address_list(const char* text) {
+    std::vector<uint32_t> addresses;
+    while (*text) {
+        char* end;
+        unsigned long value = std::strtoul(text, &end, 16);
+        if (end == text) {
+            ++text;
+            continue;
         }
+        addresses.push_back(static_cast<uint32_t>(value));
+        text = end;
     }
-
-    // *** If it's not HEX, assume it's Binary for this tool ***
-    return FileType::RawBinary;
+    return addresses;
 }
 
-
 int main(int, char**) {
     // *** 1. Initialize SDL (Same as before) ***
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0) { return -1; }
@@ -104,14 +99,48 @@ int main(int, char**) {
     ImGui_ImplSDLRenderer2_Init(renderer);
 
     // *** 3. Application State ***
-    enum class CpuType { I8080, I8085 };
     CpuType selected_cpu = CpuType::I8080;
-    std::unique_ptr<CpuDisassembler> disassembler = std::make_unique<Disassembler8080>();
+    CodeFlowOptions flow_options;            // Linear sweep or follow-flow, and its entry points
+    char entry_points_text[128] = "";
+    int hex_record_size_index = 0; // Index into hex_record_sizes for "Save HEX..."
+    // "Save Binary..." settings
+    BinaryExportOptions binary_export;
+    bool export_whole_image = true;
+    uint32_t export_start = 0;
+    uint32_t export_end = 0xFFFF;
+    int prom_size_index = 0;
+    int interleave_index = 0;
     std::string current_filename = "No file loaded";
-    std::vector<HexRecord> loaded_records;
-    MemoryMap memory_map; // Add the memory map to our application's state
+    // The loaded file is built by the pipeline off the render thread and
+    // swapped in whole once it is ready, together with its disassembly.
+    LoadPipeline pipeline;
+    std::shared_ptr<const LoadedFile> loaded_file = std::make_shared<LoadedFile>();
     std::vector<DisassembledInstruction> disassembly;
-    SymbolMap symbol_map;
+    CpuType disassembly_cpu = CpuType::I8080;   // The CPU 'disassembly' was decoded for
+    std::vector<uint32_t> disassembly_rows;
+    std::shared_ptr<const SymbolMap> disassembly_symbols = std::make_shared<const SymbolMap>(); // Its labels
+    std::shared_ptr<const SymbolMap> generated_symbols = disassembly_symbols; // The labels found by the analysis
+    SymbolMap imported_symbols; // From "Load Symbols...", kept until another file is opened
+    std::shared_ptr<const XrefIndex> disassembly_xrefs = std::make_shared<const XrefIndex>(); // Who refers to what
+    // The Memory Viewer's line index, built once per load: the image's
+    // segments and where each starts in the run of present bytes. Line N
+    // shows present bytes [16 * N, 16 * N + 16).
+    std::vector<MemorySegment> memory_segments;
+    std::vector<uint64_t> memory_segment_offsets;
+    uint64_t memory_line_count = 0;
+
+    // The listing's labels are the generated ones with the imported names
+    // laid over them.
+    auto apply_symbols = [&]() {
+        if (imported_symbols.empty()) {
+            disassembly_symbols = generated_symbols;
+        } else {
+            auto merged = std::make_shared<SymbolMap>(*generated_symbols);
+            merged->merge(imported_symbols);
+            disassembly_symbols = std::move(merged);
+        }
+        disassembly_rows = build_disassembly_rows(disassembly, *disassembly_symbols);
+    };
 
     // *** 4. Main Application Loop ***
     bool running = true;
@@ -122,6 +151,32 @@ int main(int, char**) {
             if (event.type == SDL_QUIT) running = false;
         }
 
+        // Pick up finished background work between frames.
+        if (std::optional<LoadResult> result = pipeline.take_result()) {
+            loaded_file = std::move(result->file);
+            disassembly = std::move(result->disassembly);
+            disassembly_cpu = result->cpu;
+            generated_symbols = std::move(result->symbols);
+            disassembly_xrefs = std::move(result->xrefs);
+            apply_symbols();
+            current_filename = loaded_file->filename;
+
+            memory_segments = loaded_file->memory.empty() ? std::vector<MemorySegment>()
+                                                          : loaded_file->memory.segments();
+            memory_segment_offsets.clear();
+            uint64_t present = 0;
+            for (const MemorySegment& segment : memory_segments) {
+                memory_segment_offsets.push_back(present);
+                present += segment.length;
+            }
+            memory_line_count = (present + 15) / 16;
+        }
+        const HexRecordSet& loaded_records = loaded_file->records;
+        const std::vector<MemoryConflict>& record_conflicts = loaded_file->conflicts;
+        const MemoryImage& memory_map = loaded_file->memory;
+        const SymbolMap& symbol_map = *disassembly_symbols;
+        const XrefIndex& xrefs = *disassembly_xrefs;
+
         ImGui_ImplSDLRenderer2_NewFrame();
         ImGui_ImplSDL2_NewFrame();
         ImGui::NewFrame();
@@ -142,41 +197,74 @@ int main(int, char**) {
             }
         }
         ImGui::SameLine();
+        if (ImGui::Button("Save HEX...")) {
+            if (!memory_map.empty()) {
+                ImGuiFileDialog::Instance()->OpenDialog("SaveHexDlgKey", "Save Intel HEX File", ".hex");
+            }
+        }
+        ImGui::SameLine();
+        const char* hex_record_sizes[] = { "16", "32", "255" };
+        ImGui::SetNextItemWidth(60.0f);
+        ImGui::Combo("Bytes/record", &hex_record_size_index, hex_record_sizes, IM_ARRAYSIZE(hex_record_sizes));
+        ImGui::SameLine();
         ImGui::Text("File: %s", current_filename.c_str());
+        if (loaded_file->type == FileType::RawBinary) {
+            ImGui::Text("Fill: %u leading bytes skipped, %u trailing bytes", loaded_file->rom_fill.leading,
+                        loaded_file->rom_fill.trailing);
+        }
 
-        
-        // Need to re-disassemble if the file is loaded OR if the CPU type changes.
-        // Here lets combine the logic
-        if (!memory_map.empty() && disassembly.empty()) {
-            uint32_t pc = memory_map.begin()->first;
-            uint32_t end_addr = memory_map.rbegin()->first;
-            while (pc <= end_addr) {
-                // Heuristic for data blocks
-                uint8_t current_byte = memory_map.count(pc) ? memory_map.at(pc) : 0xFF;
-                if (current_byte == 0x00 || current_byte == 0xFF) {
-                    size_t count = 0;
-                    while (memory_map.count(pc + count) && memory_map.at(pc + count) == current_byte) {
-                        count++;
-                    }
-                    if (count >= 4) {
-                        std::stringstream ss;
-                        ss << "DB   0" << std::hex << std::uppercase << (int)current_byte << "h (" << std::dec << count << " bytes)";
-                        disassembly.push_back({pc, ss.str(), (uint8_t)count});
-                        pc += count;
-                        continue;
-                    }
-                }
-                
-                DisassembledInstruction instr = disassembler->disassemble_op(memory_map, pc, symbol_map);
-                disassembly.push_back(instr);
-                pc += instr.size;
-
-                if (memory_map.find(pc) == memory_map.end() && pc <= end_addr) {
-                    auto it = memory_map.upper_bound(pc);
-                    if (it == memory_map.end()) break;
-                    pc = it->first;
+        // -- Binary export options, used by "Save Binary..." --
+        if (ImGui::CollapsingHeader("Binary Export Options")) {
+            ImGui::SetNextItemWidth(60.0f);
+            ImGui::InputScalar("Fill byte", ImGuiDataType_U8, &binary_export.fill, nullptr, nullptr, "%02X",
+                               ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::Checkbox("Whole image", &export_whole_image);
+            if (!export_whole_image) {
+                ImGui::SetNextItemWidth(100.0f);
+                ImGui::InputScalar("Start", ImGuiDataType_U32, &export_start, nullptr, nullptr, "%08X",
+                                   ImGuiInputTextFlags_CharsHexadecimal);
+                ImGui::SameLine();
+                ImGui::SetNextItemWidth(100.0f);
+                ImGui::InputScalar("End", ImGuiDataType_U32, &export_end, nullptr, nullptr, "%08X",
+                                   ImGuiInputTextFlags_CharsHexadecimal);
+            }
+            const char* prom_sizes[] = { "No split", "2716 (2K)", "2732 (4K)", "2764 (8K)", "27128 (16K)", "27256 (32K)", "27512 (64K)" };
+            ImGui::SetNextItemWidth(140.0f);
+            ImGui::Combo("Split into PROMs", &prom_size_index, prom_sizes, IM_ARRAYSIZE(prom_sizes));
+            const char* interleaves[] = { "None", "Even/Odd (16-bit)", "4-way (32-bit)" };
+            ImGui::SetNextItemWidth(140.0f);
+            ImGui::Combo("Interleave", &interleave_index, interleaves, IM_ARRAYSIZE(interleaves));
+        }
+
+        // -- Background loading progress --
+        if (pipeline.busy()) {
+            char overlay[64];
+            std::snprintf(overlay, sizeof(overlay), "%s... %d%%", LoadPipeline::stage_name(pipeline.stage()),
+                          static_cast<int>(pipeline.progress() * 100));
+            ImGui::ProgressBar(pipeline.progress(), ImVec2(-100.0f, 0.0f), overlay);
+            ImGui::SameLine();
+            if (ImGui::Button("Cancel")) {
+                pipeline.cancel();
+            }
+        }
+
+        // -- Overlapping data records --
+        if (!record_conflicts.empty()) {
+            size_t differing = std::count_if(record_conflicts.begin(), record_conflicts.end(),
+                                             [](const MemoryConflict& c) { return !c.identical; });
+            std::string header = "Overlapping Records: " + std::to_string(record_conflicts.size()) +
+                                 " (" + std::to_string(differing) + " with different data)";
+            if (ImGui::CollapsingHeader(header.c_str())) {
+                for (const auto& conflict : record_conflicts) {
+                    ImGui::Text("0x%08X  %3u bytes  record %u overwritten by record %u  %s",
+                                conflict.address, conflict.length, conflict.earlier.record, conflict.later.record,
+                                conflict.identical ? "identical" : "DIFFERENT");
                 }
             }
+        }
+
+
+        if (!memory_map.empty()) {
             ImGui::Separator();
 
              // -- Parsed Data Display --
@@ -185,15 +273,21 @@ int main(int, char**) {
             if (loaded_records.empty()) {
                 ImGui::Text("No data loaded.");
             } else {
-                for (const auto& record : loaded_records) {
-                    std::stringstream ss;
-                    ss << "T:" << std::hex << std::setw(2) << std::setfill('0') << (int)record.record_type
-                    << "  ADDR: " << std::setw(4) << (int)record.address
-                    << "  LEN: " << std::setw(2) << (int)record.byte_count << "  DATA: ";
-                    for (uint8_t byte : record.data) {
-                        ss << std::setw(2) << static_cast<int>(byte) << " ";
+                // Only format the records that are actually on screen.
+                ImGuiListClipper clipper;
+                clipper.Begin(static_cast<int>(loaded_records.size()));
+                while (clipper.Step()) {
+                    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                        const HexRecordView record = loaded_records[row];
+                        std::stringstream ss;
+                        ss << "T:" << std::hex << std::setw(2) << std::setfill('0') << (int)record.record_type
+                        << "  ADDR: " << std::setw(4) << (int)record.address
+                        << "  LEN: " << std::setw(2) << (int)record.byte_count << "  DATA: ";
+                        for (uint8_t byte : record.data) {
+                            ss << std::setw(2) << static_cast<int>(byte) << " ";
+                        }
+                        ImGui::TextUnformatted(ss.str().c_str());
                     }
-                    ImGui::TextUnformatted(ss.str().c_str());
                 }
             }
             ImGui::EndChild();
@@ -207,24 +301,40 @@ int main(int, char**) {
         if (memory_map.empty()) {
             ImGui::Text("No data loaded into memory.");
         } else {
-            // A simple hex editor view
-            // Note: For large files, a more advanced implementation would only render visible lines.
-            for (auto it = memory_map.begin(); it != memory_map.end(); ) {
-                // Address
-                ImGui::Text("0x%04X: ", it->first);
-                ImGui::SameLine();
-                
-                // Hex Bytes (up to 16 per line)
-                std::stringstream hex_ss;
-                for (int i = 0; i < 16; ++i) {
-                    if (it != memory_map.end()) {
-                        hex_ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(it->second) << " ";
-                        ++it;
-                    } else {
-                        hex_ss << "   ";
+            // A simple hex editor view, 16 present bytes per line, read straight from the segments.
+            // Only the lines on screen are formatted; the line index finds where each one starts.
+            static const char hex_digits[] = "0123456789abcdef";
+            char hex_line[16 * 3 + 1];
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(memory_line_count));
+            while (clipper.Step()) {
+                for (int line = clipper.DisplayStart; line < clipper.DisplayEnd; ++line) {
+                    uint64_t first = uint64_t(line) * 16;
+                    size_t s = std::upper_bound(memory_segment_offsets.begin(), memory_segment_offsets.end(), first) -
+                               memory_segment_offsets.begin() - 1;
+                    size_t offset = size_t(first - memory_segment_offsets[s]);
+                    uint32_t line_address = memory_segments[s].start + static_cast<uint32_t>(offset);
+                    int line_fill = 0;
+                    // A line runs on into the next segment, as the bytes are counted without the gaps.
+                    while (line_fill < 16 && s < memory_segments.size()) {
+                        uint8_t byte = memory_segments[s].data[offset];
+                        hex_line[line_fill * 3] = hex_digits[byte >> 4];
+                        hex_line[line_fill * 3 + 1] = hex_digits[byte & 0x0F];
+                        hex_line[line_fill * 3 + 2] = ' ';
+                        ++line_fill;
+                        if (++offset == memory_segments[s].length) {
+                            ++s;
+                            offset = 0;
+                        }
+                    }
+                    for (int i = line_fill; i < 16; ++i) {
+                        std::memcpy(hex_line + i * 3, "   ", 3);
                     }
+                    hex_line[16 * 3] = '\0';
+                    ImGui::Text("0x%04X: ", line_address);
+                    ImGui::SameLine();
+                    ImGui::TextUnformatted(hex_line);
                 }
-                ImGui::TextUnformatted(hex_ss.str().c_str());
             }
         }
         ImGui::End();
@@ -238,13 +348,12 @@ int main(int, char**) {
         if (ImGui::Combo("CPU", &current_cpu_index, cpu_names, IM_ARRAYSIZE(cpu_names))){
             selected_cpu = static_cast<CpuType>(current_cpu_index);
 
-            // When the CPU is changed, create the correct disassembler object.
-            if(selected_cpu == CpuType::I8080){
-                disassembler = std::make_unique<Disassembler8080>();
-            } else if (selected_cpu == CpuType::I8085){
-                disassembler = std::make_unique<Disassembler8085>();
-            }
+            // When the CPU is changed, re-disassemble the current file in the background.
             disassembly.clear();
+            disassembly_rows.clear();
+            if (!memory_map.empty()) {
+                pipeline.disassemble(loaded_file, selected_cpu, flow_options);
+            }
         }
         ImGui::SameLine();
         if (ImGui::Button("Save Disassembly")) {
@@ -252,19 +361,87 @@ int main(int, char**) {
                     ImGuiFileDialog::Instance()->OpenDialog("SaveFileDlgKey", "Choose File", ".asm,.txt");
                 }
             }
+        ImGui::SameLine();
+        if (ImGui::Button("Load Symbols...")) {
+            ImGuiFileDialog::Instance()->OpenDialog("LoadSymbolsDlgKey", "Load Symbols", ".sym,.map,.lst,.prn,.*");
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Save Symbols...")) {
+            if (!symbol_map.empty()) {
+                ImGuiFileDialog::Instance()->OpenDialog("SaveSymbolsDlgKey", "Save Symbols", ".sym,.map");
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Save Xrefs...")) {
+            if (!xrefs.empty()) {
+                ImGuiFileDialog::Instance()->OpenDialog("SaveXrefsDlgKey", "Save Cross Reference", ".xrf,.txt");
+            }
+        }
+
+        // Follow the code from its entry points instead of sweeping every byte.
+        bool follow_flow = flow_options.mode == DisassemblyMode::FollowFlow;
+        bool flow_changed = ImGui::Checkbox("Follow code flow", &follow_flow);
+        if (follow_flow) {
+            ImGui::SameLine();
+            flow_changed |= ImGui::Checkbox("RST vectors", &flow_options.interrupt_vectors);
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(200.0f);
+            if (ImGui::InputText("Entry points (hex)", entry_points_text, sizeof(entry_points_text),
+                                 ImGuiInputTextFlags_EnterReturnsTrue)) {
+                flow_options.entry_points = parse_address_list(entry_points_text);
+                flow_changed = true;
+            }
+        }
+        if (flow_changed) {
+            flow_options.mode = follow_flow ? DisassemblyMode::FollowFlow : DisassemblyMode::LinearSweep;
+            disassembly.clear();
+            disassembly_rows.clear();
+            if (!memory_map.empty()) {
+                pipeline.disassemble(loaded_file, selected_cpu, flow_options);
+            }
+        }
 
         ImGui::Separator();
 
         ImGui::BeginChild("DisassemblyScrolling");
         if (disassembly.empty()) {
-            ImGui::Text("No disassembly available. Load a file or select a CPU.");
+            ImGui::Text("%s", pipeline.busy() ? "Working..." : "No disassembly available. Load a file or select a CPU.");
         } else {
-            for (const auto& instr : disassembly) {
-                if (symbol_map.count(instr.address)) {
-                    ImGui::Spacing();
-                    ImGui::Text("%s:", symbol_map.at(instr.address).c_str());
+            // Instruction text is only produced for the rows on screen.
+            const OpcodeTable& opcodes = opcode_table(disassembly_cpu);
+            char text[128];
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(disassembly_rows.size()));
+            while (clipper.Step()) {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                    const DisassembledInstruction& instr = disassembly[disassembly_rows[row] & ~kLabelRow];
+                    if (disassembly_rows[row] & kLabelRow) {
+                        char* end = symbol_map.format_name(text, text + sizeof(text), *symbol_map.find(instr.address));
+                        ImGui::Text("%.*s:", static_cast<int>(end - text), text);
+                        continue;
+                    }
+                    char* end = format_instruction(text, text + sizeof(text), instr, opcodes, symbol_map);
+                    ImGui::Text("  0x%04X:  %.*s", instr.address, static_cast<int>(end - text), text);
+
+                    // Who refers to this address; the list shows on hover.
+                    XrefList refs = xrefs.refs_to(instr.address);
+                    if (!refs.empty()) {
+                        ImGui::SameLine();
+                        ImGui::TextDisabled("; %zu ref%s", refs.size(), refs.size() == 1 ? "" : "s");
+                        if (ImGui::IsItemHovered()) {
+                            const size_t max_shown = 24;
+                            ImGui::BeginTooltip();
+                            for (size_t i = 0; i < refs.size() && i < max_shown; ++i) {
+                                const Xref& ref = refs.first[i];
+                                ImGui::Text("%-5s from 0x%04X", xref_kind_name(ref.kind), ref.from);
+                            }
+                            if (refs.size() > max_shown) {
+                                ImGui::TextDisabled("... and %zu more", refs.size() - max_shown);
+                            }
+                            ImGui::EndTooltip();
+                        }
+                    }
                 }
-                ImGui::Text("  0x%04X:  %s", instr.address, instr.instruction_text.c_str());
             }
         }
         ImGui::EndChild();
@@ -275,33 +452,15 @@ int main(int, char**) {
             if (ImGuiFileDialog::Instance()->IsOk()) {
                 std::string file_path = ImGuiFileDialog::Instance()->GetFilePathName();
                 current_filename = ImGuiFileDialog::Instance()->GetCurrentFileName();
-                
-                // Clear all data before loading new file
-                memory_map.clear();
-                loaded_records.clear();
-                disassembly.clear();
-                symbol_map.clear();
-                
-                FileType type = detect_file_type(file_path);
-
-                if (type == FileType::IntelHex) {
-                    loaded_records = parse_hex_file(file_path);
-                    memory_map = build_memory_map(loaded_records);
-                } else if (type == FileType::RawBinary) {
-                    // Call your binary parser. Note the 0x0000 base address for Space Invaders.
-                    uint32_t start_offset = find_rom_start_offset(file_path);
-                    memory_map = parse_binary_file(file_path, start_offset);
-                    loaded_records.clear(); // Binary files don't have records
-                } else {
-                    // Handle unknown or error case
-                    current_filename = "Error: Could not identify file type.";
-                    memory_map.clear();
-                }
 
-                // Use our new parser to load the file!
-                //loaded_records = parse_hex_file(file_path);
-                //memory_map = build_memory_map(loaded_records);
-                symbol_map = generate_symbols(memory_map);
+                // Clear all data before loading new file. Opening another file
+                // cancels whatever the pipeline was still doing.
+                loaded_file = std::make_shared<LoadedFile>();
+                disassembly.clear();
+                disassembly_rows.clear();
+                imported_symbols.clear();
+                disassembly_xrefs = std::make_shared<const XrefIndex>();
+                pipeline.load(file_path, current_filename, selected_cpu, flow_options);
             } 
             ImGuiFileDialog::Instance()->Close();
         }
@@ -315,22 +474,75 @@ int main(int, char**) {
                 std::ofstream out_file(file_path);
                 if (out_file.is_open()) {
                     // loop through the disassembly data and write it to the file
-                    for (const auto& instr : disassembly) {
-                        std::stringstream ss;
-                        if (symbol_map.count(instr.address)) {
-                            ss << "\n" << symbol_map.at(instr.address) << ":\n";
-                        }
-                        ss << "  0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0')
-                           << instr.address << ":  " << instr.instruction_text << "\n";
-                        
-                        out_file << ss.str();
-                    }
+                    write_disassembly_listing(out_file, disassembly, disassembly_cpu, symbol_map);
                     out_file.close();
                 }
             }
             ImGuiFileDialog::Instance()->Close();
         }
 
+        // File Dialog Logic for importing labels from a .sym/.map/.lst file
+        if (ImGuiFileDialog::Instance()->Display("LoadSymbolsDlgKey")) {
+            if (ImGuiFileDialog::Instance()->IsOk()) {
+                std::string file_path = ImGuiFileDialog::Instance()->GetFilePathName();
+                if (import_symbol_file(file_path, imported_symbols)) {
+                    apply_symbols();
+                }
+            }
+            ImGuiFileDialog::Instance()->Close();
+        }
+
+        // File Dialog Logic for exporting the listing's labels
+        if (ImGuiFileDialog::Instance()->Display("SaveSymbolsDlgKey")) {
+            if (ImGuiFileDialog::Instance()->IsOk()) {
+                std::string file_path = ImGuiFileDialog::Instance()->GetFilePathName();
+                export_symbol_file(file_path, *disassembly_symbols);
+            }
+            ImGuiFileDialog::Instance()->Close();
+        }
+
+        // File Dialog Logic for saving the cross reference table
+        if (ImGuiFileDialog::Instance()->Display("SaveXrefsDlgKey")) {
+            if (ImGuiFileDialog::Instance()->IsOk()) {
+                std::string file_path = ImGuiFileDialog::Instance()->GetFilePathName();
+                std::ofstream out_file(file_path);
+                if (out_file.is_open()) {
+                    write_xref_listing(out_file, *disassembly_xrefs, *disassembly_symbols);
+                }
+            }
+            ImGuiFileDialog::Instance()->Close();
+        }
+
+        // File Dialog Logic for saving the image as a flat binary
+        if (ImGuiFileDialog::Instance()->Display("SaveBinaryDlgKey")) {
+            if (ImGuiFileDialog::Instance()->IsOk()) {
+                std::string file_path = ImGuiFileDialog::Instance()->GetFilePathName();
+                const unsigned interleave_lanes[] = { 1, 2, 4 };
+                BinaryExportOptions options = binary_export;
+                if (!export_whole_image) {
+                    options.start = export_start;
+                    options.end = export_end;
+                }
+                options.split_size = prom_size_index == 0 ? 0 : (1024u << prom_size_index);
+                options.interleave = interleave_lanes[interleave_index];
+                export_binary_file(file_path, memory_map, options);
+            }
+            ImGuiFileDialog::Instance()->Close();
+        }
+
+        // File Dialog Logic for saving the image as Intel HEX
+        if (ImGuiFileDialog::Instance()->Display("SaveHexDlgKey")) {
+            if (ImGuiFileDialog::Instance()->IsOk()) {
+                std::string file_path = ImGuiFileDialog::Instance()->GetFilePathName();
+                const uint8_t record_sizes[] = { 16, 32, 255 };
+                HexWriteOptions options;
+                options.record_size = record_sizes[hex_record_size_index];
+                options.start_address = find_start_address(loaded_records); // Keep the file's start record
+                write_hex_file(file_path, memory_map, options);
+            }
+            ImGuiFileDialog::Instance()->Close();
+        }
+
         // *** 5. Render the frame ***
         ImGui::Render();
         SDL_SetRenderDrawColor(renderer, 45, 55, 60, 255);
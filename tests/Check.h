@@ -0,0 +1,47 @@
+#pragma once
+
+// The few helpers the checks share. There is no test framework: each check
+// is a small program that prints what failed and exits non-zero if anything
+// did, so "make check" can run them one after another.
+
+#include <cstdio>
+#include <cstdint>
+
+inline int check_failures = 0;
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition);      \
+            ++check_failures;                                                               \
+        }                                                                                   \
+    } while (0)
+
+// Prints the verdict and returns the process exit code.
+inline int check_result(const char* name) {
+    if (check_failures == 0) {
+        std::printf("%s: ok\n", name);
+        return 0;
+    }
+    std::printf("%s: %d failure(s)\n", name, check_failures);
+    return 1;
+}
+
+// A small, fast, reproducible generator (xorshift64*), so a failing case
+// can be replayed from its seed.
+class CheckRandom {
+    public:
+        explicit CheckRandom(uint64_t seed) : state_(seed * 0x9E3779B97F4A7C15ull + 1) {}
+
+        uint64_t next() {
+            state_ ^= state_ >> 12;
+            state_ ^= state_ << 25;
+            state_ ^= state_ >> 27;
+            return state_ * 0x2545F4914F6CDD1Dull;
+        }
+        // Uniform in [0, bound).
+        uint32_t below(uint32_t bound) { return static_cast<uint32_t>(next() % bound); }
+
+    private:
+        uint64_t state_;
+};
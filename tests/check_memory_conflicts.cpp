@@ -0,0 +1,167 @@
+// Differential check: find_memory_conflicts, built on an interval tree,
+// must report exactly what a brute-force scan of every pair of data records
+// finds. Random inputs mix data records with 0x02/0x04 records that move
+// them between segments, and several inputs are checked together the way a
+// bootloader and its application are merged.
+//
+// Usage: check_memory_conflicts [case count] [first seed]
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <tuple>
+#include <vector>
+
+#include "Check.h"
+#include "MemoryConflicts.h"
+
+// Adds a record with its checksum.
+static void add_record(HexRecordSet& records, uint8_t type, uint16_t address, const std::vector<uint8_t>& data) {
+    uint32_t sum = uint32_t(data.size()) + (address >> 8) + (address & 0xFF) + type;
+    for (uint8_t byte : data) {
+        sum += byte;
+    }
+    records.push_back({static_cast<uint8_t>(data.size()), address, type, {data.data(), data.size()},
+                       static_cast<uint8_t>(-sum)});
+}
+
+// Records crowded into a few small windows so that many of them overlap.
+// Payloads come from a tiny alphabet, so overlaps are often identical.
+static HexRecordSet make_input(CheckRandom& random) {
+    static const uint16_t uppers[] = {0x0000, 0x0001, 0x1000, 0xFFFF};
+    HexRecordSet records;
+    size_t count = 1 + random.below(200);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t kind = random.below(10);
+        if (kind == 0) { // 0x04: upper 16 bits of the address
+            uint16_t upper = uppers[random.below(4)];
+            add_record(records, 0x04, 0, {uint8_t(upper >> 8), uint8_t(upper)});
+        } else if (kind == 1) { // 0x02: segment, which can land on the same bytes as a 0x04
+            uint16_t segment = random.below(2) ? 0x1000 : static_cast<uint16_t>(random.below(0x20));
+            add_record(records, 0x02, 0, {uint8_t(segment >> 8), uint8_t(segment)});
+        } else if (kind == 2) { // Records that do not write data, including an empty data record
+            add_record(records, random.below(2) ? 0x05 : 0x00, 0, {});
+        } else {
+            uint16_t address = static_cast<uint16_t>(random.below(2) ? random.below(0x100)
+                                                                      : 0xFF00 + random.below(0x100));
+            std::vector<uint8_t> data(1 + random.below(32));
+            for (uint8_t& byte : data) {
+                byte = static_cast<uint8_t>(random.below(2));
+            }
+            add_record(records, 0x00, address, data);
+        }
+    }
+    return records;
+}
+
+// Every pair of overlapping data records, found by comparing each record
+// with every earlier one. Addresses are resolved per input, from scratch.
+static std::vector<MemoryConflict> brute_force_conflicts(const std::vector<const HexRecordSet*>& inputs) {
+    struct Placed {
+        uint64_t start;
+        ByteSpan data;
+        RecordRef source;
+    };
+    std::vector<Placed> placed;
+    for (uint32_t input = 0; input < inputs.size(); ++input) {
+        uint64_t base = 0;
+        for (uint32_t index = 0; index < inputs[input]->size(); ++index) {
+            HexRecordView record = (*inputs[input])[index];
+            uint64_t upper = record.data.size >= 2 ? (record.data[0] << 8) | record.data[1] : 0;
+            if (record.record_type == 0x04 && record.data.size >= 2) {
+                base = upper * 0x10000;
+            } else if (record.record_type == 0x02 && record.data.size >= 2) {
+                base = upper * 16;
+            } else if (record.record_type == 0x00 && record.data.size > 0) {
+                placed.push_back({base + record.address, record.data, {input, index}});
+            }
+        }
+    }
+
+    std::vector<MemoryConflict> conflicts;
+    for (size_t later = 0; later < placed.size(); ++later) {
+        for (size_t earlier = 0; earlier < later; ++earlier) {
+            const Placed& a = placed[earlier];
+            const Placed& b = placed[later];
+            uint64_t start = std::max(a.start, b.start);
+            uint64_t end = std::min(a.start + a.data.size, b.start + b.data.size);
+            if (start >= end) {
+                continue;
+            }
+            bool identical = true;
+            for (uint64_t address = start; address < end; ++address) {
+                identical = identical && a.data[address - a.start] == b.data[address - b.start];
+            }
+            conflicts.push_back({static_cast<uint32_t>(start), static_cast<uint32_t>(end - start), a.source,
+                                 b.source, identical});
+        }
+    }
+    std::sort(conflicts.begin(), conflicts.end(), [](const MemoryConflict& a, const MemoryConflict& b) {
+        return std::make_tuple(a.address, a.earlier.input, a.earlier.record, a.later.input, a.later.record) <
+               std::make_tuple(b.address, b.earlier.input, b.earlier.record, b.later.input, b.later.record);
+    });
+    return conflicts;
+}
+
+static bool same_conflict(const MemoryConflict& a, const MemoryConflict& b) {
+    return a.address == b.address && a.length == b.length && a.earlier.input == b.earlier.input &&
+           a.earlier.record == b.earlier.record && a.later.input == b.later.input &&
+           a.later.record == b.later.record && a.identical == b.identical;
+}
+
+// Compares one case; prints the first difference.
+static void compare(const std::vector<const HexRecordSet*>& inputs, uint64_t seed) {
+    std::vector<MemoryConflict> expected = brute_force_conflicts(inputs);
+    std::vector<MemoryConflict> found = find_memory_conflicts(inputs);
+    size_t common = std::min(expected.size(), found.size());
+    size_t i = 0;
+    while (i < common && same_conflict(expected[i], found[i])) {
+        ++i;
+    }
+    if (i == common && expected.size() == found.size()) {
+        return;
+    }
+    ++check_failures;
+    std::printf("seed %llu, %zu inputs: %zu vs %zu conflicts, first difference at index %zu\n",
+                static_cast<unsigned long long>(seed), inputs.size(), expected.size(), found.size(), i);
+}
+
+// A bootloader and an application that share its last bytes.
+static void check_bootloader_and_application() {
+    HexRecordSet boot, application;
+    add_record(boot, 0x04, 0, {0x00, 0x01});
+    add_record(boot, 0x00, 0x0000, {1, 2, 3, 4, 5, 6, 7, 8});
+    add_record(application, 0x02, 0, {0x10, 0x00}); // 0x10000 again, through a segment
+    add_record(application, 0x00, 0x0006, {7, 9, 9, 9});
+    add_record(application, 0x00, 0x0100, {0xC9});
+
+    std::vector<MemoryConflict> conflicts = find_memory_conflicts({&boot, &application});
+    CHECK(conflicts.size() == 1);
+    if (!conflicts.empty()) {
+        CHECK(conflicts[0].address == 0x10006);
+        CHECK(conflicts[0].length == 2);
+        CHECK(conflicts[0].earlier.input == 0 && conflicts[0].earlier.record == 1);
+        CHECK(conflicts[0].later.input == 1 && conflicts[0].later.record == 1);
+        CHECK(!conflicts[0].identical);
+    }
+    CHECK(find_memory_conflicts(boot).empty());
+    CHECK(find_memory_conflicts(application).empty());
+}
+
+int main(int argc, char** argv) {
+    int case_count = argc > 1 ? std::atoi(argv[1]) : 300;
+    uint64_t first_seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+
+    check_bootloader_and_application();
+    for (int n = 0; n < case_count; ++n) {
+        uint64_t seed = first_seed + n;
+        CheckRandom random(seed);
+        std::vector<HexRecordSet> sets(1 + random.below(3));
+        std::vector<const HexRecordSet*> inputs;
+        for (HexRecordSet& records : sets) {
+            records = make_input(random);
+            inputs.push_back(&records);
+        }
+        compare(inputs, seed);
+    }
+    return check_result("memory conflicts match a pairwise scan");
+}
@@ -0,0 +1,147 @@
+// Differential check: disassemble_image_parallel must produce exactly the
+// listing of the serial disassemble_image, whatever the window layout.
+// Random images are built to hit the hard cases for window stitching:
+// operands and 0x00/0xFF runs crossing window edges, segments separated by
+// 1-3 byte gaps (operands read through the image), many small segments
+// sharing a window, and a segment ending at the top of the address space.
+//
+// Usage: check_parallel_sweep [image count] [first seed]
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Check.h"
+#include "Disassembly.h"
+#include "MemoryImage.h"
+
+// Appends 'length' bytes of mixed content: random bytes, fill runs of every
+// length around the 4-byte folding threshold, and streams of 3-byte opcodes.
+static void fill_segment(CheckRandom& random, std::vector<uint8_t>& bytes, size_t length) {
+    static const uint8_t three_byte_opcodes[] = {0xC3, 0xCD, 0x21, 0x3A, 0x32, 0x22, 0x2A, 0xC2, 0xCC};
+    while (bytes.size() < length) {
+        size_t left = length - bytes.size();
+        switch (random.below(4)) {
+            case 0: { // Random bytes
+                size_t count = std::min<size_t>(left, 1 + random.below(4096));
+                for (size_t i = 0; i < count; ++i) {
+                    bytes.push_back(static_cast<uint8_t>(random.next()));
+                }
+                break;
+            }
+            case 1: { // A 0x00 or 0xFF run, often short
+                size_t count = std::min<size_t>(left, 1 + (random.below(2) ? random.below(8) : random.below(3000)));
+                bytes.insert(bytes.end(), count, random.below(2) ? 0x00 : 0xFF);
+                break;
+            }
+            case 2: { // 3-byte instructions, some with fill operands
+                size_t count = std::min<size_t>(left, 3 * (1 + random.below(500)));
+                for (size_t i = 0; i < count; ++i) {
+                    if (i % 3 == 0) {
+                        bytes.push_back(three_byte_opcodes[random.below(sizeof(three_byte_opcodes))]);
+                    } else {
+                        bytes.push_back(random.below(4) ? static_cast<uint8_t>(random.next()) : 0x00);
+                    }
+                }
+                break;
+            }
+            default: { // Alternating fill and single opcodes, to stress run edges
+                size_t count = std::min<size_t>(left, 1 + random.below(64));
+                for (size_t i = 0; i < count; ++i) {
+                    bytes.push_back(random.below(3) ? 0xFF : 0xCD);
+                }
+                break;
+            }
+        }
+    }
+}
+
+// An image of 600 KB to 3 MB in 1 to 40 segments, written in shuffled order.
+static MemoryImage make_image(uint64_t seed) {
+    CheckRandom random(seed);
+    size_t segment_count = 1 + random.below(random.below(2) ? 40 : 6);
+    size_t total = 600 * 1024 + random.below(2400 * 1024);
+
+    struct Block {
+        uint32_t start;
+        std::vector<uint8_t> bytes;
+    };
+    std::vector<Block> blocks;
+    uint64_t address = random.below(2) ? 0 : random.below(0x100000);
+    for (size_t s = 0; s < segment_count; ++s) {
+        size_t length = std::max<size_t>(1, total / segment_count / 2 + random.below(uint32_t(total / segment_count)));
+        Block block{static_cast<uint32_t>(address), {}};
+        fill_segment(random, block.bytes, length);
+        address += length;
+        // Mostly tiny gaps, so operands run into the next segment.
+        address += random.below(2) ? 1 + random.below(3) : 1 + random.below(0x20000);
+        blocks.push_back(std::move(block));
+    }
+    if (random.below(4) == 0) {
+        // Move the last segment up against 0xFFFFFFFF.
+        Block& last = blocks.back();
+        last.start = static_cast<uint32_t>(0x100000000ull - last.bytes.size());
+    }
+
+    for (size_t i = blocks.size(); i > 1; --i) {
+        std::swap(blocks[i - 1], blocks[random.below(static_cast<uint32_t>(i))]);
+    }
+    MemoryImage image;
+    for (const Block& block : blocks) {
+        image.write_block(block.start, block.bytes.data(), block.bytes.size());
+    }
+    image.compact();
+    return image;
+}
+
+static bool same_instruction(const DisassembledInstruction& a, const DisassembledInstruction& b) {
+    return a.address == b.address && a.operand == b.operand && a.opcode == b.opcode && a.size == b.size &&
+           a.flags == b.flags;
+}
+
+// Compares one parallel run with the serial listing; prints the first difference.
+static void compare(const std::vector<DisassembledInstruction>& serial,
+                    const std::vector<DisassembledInstruction>& parallel, uint64_t seed, const char* cpu,
+                    unsigned threads) {
+    size_t common = std::min(serial.size(), parallel.size());
+    size_t i = 0;
+    while (i < common && same_instruction(serial[i], parallel[i])) {
+        ++i;
+    }
+    if (i == common && serial.size() == parallel.size()) {
+        return;
+    }
+    ++check_failures;
+    std::printf("seed %llu, %s, %u threads: %zu vs %zu instructions, first difference at index %zu",
+                static_cast<unsigned long long>(seed), cpu, threads, serial.size(), parallel.size(), i);
+    if (i < common) {
+        std::printf(" (serial 0x%08X size %u, parallel 0x%08X size %u)", serial[i].address, serial[i].size,
+                    parallel[i].address, parallel[i].size);
+    }
+    std::printf("\n");
+}
+
+int main(int argc, char** argv) {
+    int image_count = argc > 1 ? std::atoi(argv[1]) : 12;
+    uint64_t first_seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+    const unsigned thread_counts[] = {1, 2, 3, 8, 64};
+    const struct {
+        CpuType cpu;
+        const char* name;
+    } cpus[] = {{CpuType::I8080, "8080"}, {CpuType::I8085, "8085"}};
+
+    for (int n = 0; n < image_count; ++n) {
+        uint64_t seed = first_seed + n;
+        MemoryImage image = make_image(seed);
+        for (const auto& cpu : cpus) {
+            std::unique_ptr<CpuDisassembler> disassembler = make_disassembler(cpu.cpu);
+            std::vector<DisassembledInstruction> serial = disassemble_image(image, *disassembler);
+            for (unsigned threads : thread_counts) {
+                compare(serial, disassemble_image_parallel(image, *disassembler, nullptr, threads), seed, cpu.name,
+                        threads);
+            }
+        }
+    }
+    return check_result("parallel sweep matches serial sweep");
+}
@@ -0,0 +1,201 @@
+// Checks the symbol file reader and writer on the layouts it supports:
+// CP/M .SYM pairs, equates (alone and among source code), linker maps, and
+// assembler listings with and without line numbers.
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "Check.h"
+#include "SymbolFile.h"
+
+// Imports 'text' into a fresh map.
+static SymbolMap import_text(const std::string& text, SymbolFileFormat format, size_t* count = nullptr) {
+    SymbolMap symbols;
+    size_t read = import_symbols(text.data(), text.size(), format, symbols);
+    if (count) {
+        *count = read;
+    }
+    return symbols;
+}
+
+// The name at 'address', or "" if it has none.
+static std::string name_at(const SymbolMap& symbols, uint32_t address) {
+    const SymbolMap::Symbol* symbol = symbols.find(address);
+    return symbol ? symbols.name(*symbol) : std::string();
+}
+
+static void check_cpm_sym() {
+    size_t count = 0;
+    SymbolMap symbols = import_text("0100 START 0103 LOOP\r\n"
+                                    "0110 ?PRINT 0200 DATA_1\r\n"
+                                    "\x1A\x1A",
+                                    SymbolFileFormat::CpmSym, &count);
+    CHECK(count == 4);
+    CHECK(symbols.size() == 4);
+    CHECK(name_at(symbols, 0x0100) == "START");
+    CHECK(name_at(symbols, 0x0103) == "LOOP");
+    CHECK(name_at(symbols, 0x0110) == "?PRINT");
+    CHECK(name_at(symbols, 0x0200) == "DATA_1");
+
+    // A line stops at the first pair that does not parse.
+    symbols = import_text("0100 START ZZZZ BAD 0200 LATER\n", SymbolFileFormat::CpmSym);
+    CHECK(symbols.size() == 1);
+    CHECK(name_at(symbols, 0x0100) == "START");
+}
+
+static void check_equates() {
+    SymbolMap symbols = import_text("; BIOS entry points\n"
+                                    "BOOT    EQU  0F200H\n"
+                                    "WBOOT:  equ  $F203\n"
+                                    "CONST   =    0xF206\n"
+                                    "BDOS    SET  5          ; bare numbers are decimal\n"
+                                    "TPA     EQU  256\n"
+                                    "MASK    EQU  1010B\n"
+                                    "MODE    EQU  17Q\n"
+                                    "START   0100\n"
+                                    "0180 MAIN\n"
+                                    "bad line\n",
+                                    SymbolFileFormat::Equates);
+    CHECK(name_at(symbols, 0xF200) == "BOOT");
+    CHECK(name_at(symbols, 0xF203) == "WBOOT");
+    CHECK(name_at(symbols, 0xF206) == "CONST");
+    CHECK(name_at(symbols, 5) == "BDOS");
+    CHECK(name_at(symbols, 0x0100) == "START"); // TPA is 256 too; the later name wins
+    CHECK(name_at(symbols, 10) == "MASK");
+    CHECK(name_at(symbols, 15) == "MODE");
+    CHECK(name_at(symbols, 0x0180) == "MAIN");
+    CHECK(symbols.size() == 8);
+
+    // The last name given to an address wins.
+    symbols = import_text("FIRST EQU 100H\nSECOND EQU 100H\n", SymbolFileFormat::Equates);
+    CHECK(symbols.size() == 1);
+    CHECK(name_at(symbols, 0x0100) == "SECOND");
+}
+
+static void check_equates_in_source() {
+    SymbolMap symbols = import_text("BDOS    EQU  5\n"
+                                    "START:  MOV A,B\n"
+                                    "        CPI 0DH\n"
+                                    "        ADD C\n"
+                                    "        DB 0FFH\n"
+                                    "        JMP 0100H\n"
+                                    "MOV A,B\n"
+                                    "CPI 0DH\n"
+                                    "DB 0FFH\n"
+                                    "LXI H,0100H\n"
+                                    "COUNT 10\n"
+                                    "LOOP: DCR C\n"
+                                    "TABLE   0200H\n"
+                                    "0300 BUFFER\n"
+                                    "  INDENT 0400\n",
+                                    SymbolFileFormat::Equates);
+    CHECK(name_at(symbols, 5) == "BDOS");
+    CHECK(name_at(symbols, 0x0200) == "TABLE");
+    CHECK(name_at(symbols, 0x0300) == "BUFFER");
+    CHECK(symbols.size() == 3);
+}
+
+static void check_map() {
+    size_t count = 0;
+    SymbolMap symbols = import_text("START 0100 LOOP 0103 DONE 0110\n"
+                                    "0200 DATA\n"
+                                    "  BUFFER 0300\n"
+                                    "BOOT EQU 0F200H\n",
+                                    SymbolFileFormat::Map, &count);
+    CHECK(count == 6);
+    CHECK(name_at(symbols, 0x0100) == "START");
+    CHECK(name_at(symbols, 0x0103) == "LOOP");
+    CHECK(name_at(symbols, 0x0110) == "DONE");
+    CHECK(name_at(symbols, 0x0200) == "DATA");
+    CHECK(name_at(symbols, 0x0300) == "BUFFER");
+    CHECK(name_at(symbols, 0xF200) == "BOOT");
+}
+
+static void check_listing_without_line_numbers() {
+    SymbolMap symbols = import_text("                   ORG  0100H\n"
+                                    "0100 C3 10 01      START: JMP LOOP\n"
+                                    "0103               TAIL:\n"
+                                    "0103 00            NOP\n"
+                                    "0110 3E 01         LOOP:  MVI A,1\n"
+                                    "0112 C9                   RET\n",
+                                    SymbolFileFormat::Listing);
+    CHECK(symbols.size() == 3);
+    CHECK(name_at(symbols, 0x0100) == "START");
+    CHECK(name_at(symbols, 0x0103) == "TAIL");
+    CHECK(name_at(symbols, 0x0110) == "LOOP");
+}
+
+static void check_listing_with_line_numbers() {
+    SymbolMap symbols = import_text("  11                      ORG  0100H\n"
+                                    "  12 0100 C3 10 01        START: JMP LOOP\n"
+                                    "1234 0103                 HEAD:\n"
+                                    "1235                      TAIL: NOP\n"
+                                    "1236                      NEXT:\n"
+                                    "1237 0110 3E 01           LOOP:  MVI A,1\n",
+                                    SymbolFileFormat::Listing);
+    CHECK(name_at(symbols, 0x0100) == "START");
+    CHECK(name_at(symbols, 0x0103) == "HEAD");
+    CHECK(name_at(symbols, 0x0110) == "LOOP");
+    // A line number alone is not an address.
+    CHECK(!symbols.contains(0x1235));
+    CHECK(!symbols.contains(0x1236));
+    CHECK(symbols.size() == 3);
+
+    // The layout comes from the code lines, even when they follow the label.
+    symbols = import_text("1234                TAIL:\n"
+                          "1235 0100 C9         RET\n",
+                          SymbolFileFormat::Listing);
+    CHECK(symbols.empty());
+
+    // Without any code bytes the layout is unknown, so nothing is guessed.
+    symbols = import_text("1234    TAIL:\n", SymbolFileFormat::Listing);
+    CHECK(symbols.empty());
+}
+
+static void check_round_trip() {
+    SymbolMap symbols;
+    symbols.add_generated(0x0010);
+    symbols.add(0x0100, "START");
+    symbols.add(0xF200, "BOOT");
+
+    for (SymbolFileFormat format : {SymbolFileFormat::CpmSym, SymbolFileFormat::Equates, SymbolFileFormat::Map}) {
+        std::ostringstream out;
+        export_symbols(out, symbols, format);
+        SymbolMap read = import_text(out.str(), format);
+        CHECK(read.size() == 3);
+        CHECK(name_at(read, 0x0010) == "L0010");
+        CHECK(name_at(read, 0x0100) == "START");
+        CHECK(name_at(read, 0xF200) == "BOOT");
+    }
+
+    std::ostringstream equates;
+    export_symbols(equates, symbols, SymbolFileFormat::Equates);
+    CHECK(equates.str().find("BOOT\tEQU\t0F200H\n") != std::string::npos);
+    std::ostringstream sym;
+    export_symbols(sym, symbols, SymbolFileFormat::CpmSym);
+    CHECK(sym.str() == "0010 L0010\n0100 START\nF200 BOOT\n");
+}
+
+static void check_format_for_path() {
+    CHECK(symbol_format_for_path("rom.sym") == SymbolFileFormat::CpmSym);
+    CHECK(symbol_format_for_path("ROM.SYM") == SymbolFileFormat::CpmSym);
+    CHECK(symbol_format_for_path("rom.lst") == SymbolFileFormat::Listing);
+    CHECK(symbol_format_for_path("rom.prn") == SymbolFileFormat::Listing);
+    CHECK(symbol_format_for_path("rom.map") == SymbolFileFormat::Map);
+    CHECK(symbol_format_for_path("ROM.MAP") == SymbolFileFormat::Map);
+    CHECK(symbol_format_for_path("bios.asm") == SymbolFileFormat::Equates);
+    CHECK(symbol_format_for_path("bios.inc") == SymbolFileFormat::Equates);
+    CHECK(symbol_format_for_path("dir.sym/rom") == SymbolFileFormat::Equates);
+}
+
+int main() {
+    check_cpm_sym();
+    check_equates();
+    check_equates_in_source();
+    check_map();
+    check_listing_without_line_numbers();
+    check_listing_with_line_numbers();
+    check_round_trip();
+    check_format_for_path();
+    return check_result("symbol files");
+}